@@ -2,8 +2,12 @@
 #define __BINARY_SERIALIZER__
 
 #include "common/armhelper.h"
+#include "common/keyopfieldsvaluesentry.h"
+#include "common/lzcodec.h"
 
+#include <inttypes.h>
 #include <string>
+#include <unordered_map>
 
 using namespace std;
 
@@ -11,13 +15,110 @@ namespace swss {
 
 class BinarySerializer {
 public:
+    /*
+     * Wire format of the body. Version 1 writes a size_t pair count and a
+     * size_t length before every string, the attribute count as a decimal
+     * string and no operation, a key without attributes is a DEL.
+     *
+     * Version 2 starts with WIRE_MAGIC and the version byte, every length
+     * and count that follows is a varint (LEB128): the DB name, the table
+     * name and the entry count, then per entry an op code, the op
+     * string for WIRE_OP_OTHER, the key and the field count, then per field
+     * a name reference and the value. A name reference is the 1-based index
+     * of a name written earlier in the message, or 0 followed by a new name,
+     * so the field names repeated by the entries of a batch are sent once.
+     *
+     * The deserializers read both versions.
+     */
+    static constexpr uint8_t WIRE_VERSION_1 = 1;
+    static constexpr uint8_t WIRE_VERSION_2 = 2;
+
+    /* Version of a serialized body, throws for an unknown version */
+    static uint8_t getWireVersion(const char* buffer, const size_t size)
+    {
+        uint32_t magic;
+        if (size < WIRE_PREAMBLE_SIZE)
+        {
+            return WIRE_VERSION_1;
+        }
+
+        // A version 1 body starts with its pair count, which never gets this big.
+        memcpy(&magic, buffer, sizeof(magic));
+        if (magic != WIRE_MAGIC)
+        {
+            return WIRE_VERSION_1;
+        }
+
+        uint8_t version = (uint8_t)buffer[sizeof(magic)];
+        if (version != WIRE_VERSION_2)
+        {
+            SWSS_LOG_THROW("serialized data has unsupported wire version %u", version);
+        }
+
+        return version;
+    }
+
+    /*
+     * Number of bytes serializeBuffer() writes for the batch, so the caller
+     * can size the buffer from the batch instead of from the worst case.
+     */
+    static size_t serializedSize(
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos,
+        uint8_t version = WIRE_VERSION_1)
+    {
+        if (version == WIRE_VERSION_2)
+        {
+            return serializedSizeV2(dbName, tableName, kcos);
+        }
+
+        // kvp count, then a length before every key and value
+        size_t size = sizeof(size_t);
+        size += 2 * sizeof(size_t) + dbName.length() + tableName.length();
+        for (auto& kco : kcos)
+        {
+            auto& fvs = kfvFieldsValues(kco);
+            size += 2 * sizeof(size_t) + kfvKey(kco).length() + countLength(fvs.size());
+            for (auto& fv : fvs)
+            {
+                size += 2 * sizeof(size_t) + fvField(fv).length() + fvValue(fv).length();
+            }
+        }
+
+        return size;
+    }
+
+    /* Serialize into the vector, growing it to the size of the batch */
+    static size_t serializeBuffer(
+        std::vector<char>& buffer,
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos,
+        uint8_t version = WIRE_VERSION_1)
+    {
+        size_t size = serializedSize(dbName, tableName, kcos, version);
+        if (buffer.size() < size)
+        {
+            buffer.resize(size);
+        }
+
+        return serializeBuffer(buffer.data(), buffer.size(), dbName, tableName, kcos, version);
+    }
+
     static size_t serializeBuffer(
         const char* buffer,
         const size_t size,
         const std::string& dbName,
         const std::string& tableName,
-        const std::vector<KeyOpFieldsValuesTuple>& kcos)
+        const std::vector<KeyOpFieldsValuesTuple>& kcos,
+        uint8_t version = WIRE_VERSION_1)
     {
+        if (version == WIRE_VERSION_2)
+        {
+            return serializeBufferV2(buffer, size, dbName, tableName, kcos);
+        }
+
         auto tmpSerializer = BinarySerializer(buffer, size);
 
         // Set the first pair as DB name and table name.
@@ -53,6 +154,12 @@ public:
         const size_t size,
         std::vector<swss::FieldValueTuple>& values)
     {
+        if (getWireVersion(buffer, size) == WIRE_VERSION_2)
+        {
+            flattenV2(buffer, size, values);
+            return;
+        }
+
         WARNINGS_NO_CAST_ALIGN;
         auto pkvp_count = (const size_t*)buffer;
         WARNINGS_RESET;
@@ -105,6 +212,18 @@ public:
         std::string& tableName,
         std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>>& kcos)
     {
+        if (getWireVersion(buffer, size) == WIRE_VERSION_2)
+        {
+            std::vector<KeyOpFieldsValuesEntry> entries;
+            deserializeBufferV2(buffer, size, dbName, tableName, entries);
+            for (auto& entry : entries)
+            {
+                kcos.push_back(std::make_shared<KeyOpFieldsValuesTuple>(entry.toTuple()));
+            }
+
+            return;
+        }
+
         std::vector<FieldValueTuple> values;
         deserializeBuffer(buffer, size, values);
         int fvs_size = -1;
@@ -148,7 +267,677 @@ public:
         }
     }
 
+    static void deserializeBuffer(
+        const char* buffer,
+        const size_t size,
+        std::string& dbName,
+        std::string& tableName,
+        std::vector<KeyOpFieldsValuesEntry>& entries)
+    {
+        if (getWireVersion(buffer, size) == WIRE_VERSION_2)
+        {
+            deserializeBufferV2(buffer, size, dbName, tableName, entries);
+            return;
+        }
+
+        if (size < sizeof(size_t))
+        {
+            SWSS_LOG_THROW("serialized data was truncated, size: %zu", size);
+        }
+
+        WARNINGS_NO_CAST_ALIGN;
+        auto pkvp_count = (const size_t*)buffer;
+        WARNINGS_RESET;
+
+        size_t kvp_count = *pkvp_count;
+        auto tmp_buffer = buffer + sizeof(size_t);
+
+        const char* key;
+        size_t keylen;
+        const char* value;
+        size_t vallen;
+
+        // The first pair is the DB name and the table name.
+        if (kvp_count == 0)
+        {
+            return;
+        }
+
+        readKeyAndValue(buffer, size, tmp_buffer, key, keylen, value, vallen);
+        dbName.assign(key, keylen);
+        tableName.assign(value, vallen);
+        kvp_count--;
+
+        // Decode straight from the buffer into the compact entries, the
+        // field and value strings are copied only once.
+        while (kvp_count > 0)
+        {
+            kvp_count--;
+
+            readKeyAndValue(buffer, size, tmp_buffer, key, keylen, value, vallen);
+            size_t fvs_size = parseCount(value, vallen);
+            if (fvs_size > kvp_count)
+            {
+                SWSS_LOG_THROW("serialized attribute count %zu exceeds remaining pair count %zu", fvs_size, kvp_count);
+            }
+
+            entries.emplace_back();
+            auto& entry = entries.back();
+            entry.reset(key, keylen, (fvs_size == 0) ? KeyOpFieldsValuesEntry::Op::DEL : KeyOpFieldsValuesEntry::Op::SET);
+
+            for (size_t i = 0; i < fvs_size; i++)
+            {
+                kvp_count--;
+
+                readKeyAndValue(buffer, size, tmp_buffer, key, keylen, value, vallen);
+                entry.addField(key, keylen, value, vallen);
+            }
+        }
+    }
+
+    /* Read only the DB name and table name that lead every message */
+    static void deserializeHeader(
+        const char* buffer,
+        const size_t size,
+        std::string& dbName,
+        std::string& tableName)
+    {
+        const char* key;
+        size_t keylen;
+        const char* value;
+        size_t vallen;
+        readHeader(buffer, size, key, keylen, value, vallen);
+        dbName.assign(key, keylen);
+        tableName.assign(value, vallen);
+    }
+
+    /*
+     * Compress a body written by serializeBuffer() into out. The pair count
+     * or version 2 preamble and the DB name and table name stay as they are,
+     * so deserializeHeader() reads a compressed body too. The size of the
+     * rest of the body and the rest compressed with LzCodec follow. Returns
+     * the compressed size, or 0 when it doesn't fit in capacity.
+     */
+    static size_t compressBody(
+        const char* body,
+        const size_t size,
+        char* out,
+        const size_t capacity)
+    {
+        size_t prefix = readHeader(body, size);
+        if (prefix + sizeof(uint64_t) >= capacity)
+        {
+            return 0;
+        }
+
+        memcpy(out, body, prefix);
+        uint64_t rest = size - prefix;
+        memcpy(out + prefix, &rest, sizeof(rest));
+
+        size_t compressed = LzCodec::compress(
+                                        body + prefix,
+                                        size - prefix,
+                                        out + prefix + sizeof(uint64_t),
+                                        capacity - prefix - sizeof(uint64_t));
+        if (compressed == 0)
+        {
+            return 0;
+        }
+
+        return prefix + sizeof(uint64_t) + compressed;
+    }
+
+    /* Restore the body compressed by compressBody(), up to maxSize bytes */
+    static void decompressBody(
+        const char* body,
+        const size_t size,
+        const size_t maxSize,
+        std::vector<char>& out)
+    {
+        size_t prefix = readHeader(body, size);
+        if (size - prefix < sizeof(uint64_t))
+        {
+            SWSS_LOG_THROW("compressed data was truncated, size: %zu", size);
+        }
+
+        uint64_t rest;
+        memcpy(&rest, body + prefix, sizeof(rest));
+        if (prefix > maxSize || rest > maxSize - prefix)
+        {
+            SWSS_LOG_THROW("compressed data expands to %" PRIu64 " bytes, more than %zu", rest, maxSize);
+        }
+
+        out.resize(prefix + (size_t)rest);
+        memcpy(out.data(), body, prefix);
+        LzCodec::decompress(
+                        body + prefix + sizeof(uint64_t),
+                        size - prefix - sizeof(uint64_t),
+                        out.data() + prefix,
+                        (size_t)rest);
+    }
+
+    /*
+     * Optional header in front of a message, written by producers that
+     * number their messages. It starts with a magic value in place of the
+     * pair count, so messages without it still decode as before.
+     */
+    struct MessageHeader
+    {
+        uint64_t flags = 0;
+        uint64_t producerId = 0;
+        uint64_t sequence = 0;
+    };
+
+    static constexpr uint64_t MESSAGE_MAGIC = 0x5357535348445231ULL;
+    static constexpr uint64_t FLAG_SEQUENCE = 0x1;
+    static constexpr uint64_t FLAG_COMPRESSED = 0x2;
+    static constexpr size_t MESSAGE_HEADER_SIZE = 4 * sizeof(uint64_t);
+
+    static void serializeMessageHeader(char* buffer, const MessageHeader& header)
+    {
+        uint64_t fields[] = { MESSAGE_MAGIC, header.flags, header.producerId, header.sequence };
+        memcpy(buffer, fields, MESSAGE_HEADER_SIZE);
+    }
+
+    /* Stamp the sequence of a header written by serializeMessageHeader() */
+    static void setMessageSequence(char* buffer, uint64_t sequence)
+    {
+        memcpy(buffer + 3 * sizeof(uint64_t), &sequence, sizeof(uint64_t));
+    }
+
+    /*
+     * Parse the header of a received message. Returns the number of bytes
+     * it takes, the body follows, or 0 when the message has no header.
+     */
+    static size_t deserializeMessageHeader(
+        const char* buffer,
+        const size_t size,
+        MessageHeader& header)
+    {
+        header = MessageHeader();
+
+        uint64_t magic;
+        if (size < sizeof(magic))
+        {
+            return 0;
+        }
+
+        memcpy(&magic, buffer, sizeof(magic));
+        if (magic != MESSAGE_MAGIC)
+        {
+            return 0;
+        }
+
+        if (size < MESSAGE_HEADER_SIZE)
+        {
+            SWSS_LOG_THROW("serialized message header was truncated, size: %zu", size);
+        }
+
+        uint64_t fields[4];
+        memcpy(fields, buffer, MESSAGE_HEADER_SIZE);
+        header.flags = fields[1];
+        header.producerId = fields[2];
+        header.sequence = fields[3];
+
+        return MESSAGE_HEADER_SIZE;
+    }
+
 private:
+    // parse the pair count and the DB name and table name pair, returns their size
+    static size_t readHeader(
+        const char* buffer,
+        const size_t size,
+        const char*& key,
+        size_t& keylen,
+        const char*& value,
+        size_t& vallen)
+    {
+        if (getWireVersion(buffer, size) == WIRE_VERSION_2)
+        {
+            const char* tmp_buffer = buffer + WIRE_PREAMBLE_SIZE;
+            readString(buffer, size, tmp_buffer, key, keylen);
+            readString(buffer, size, tmp_buffer, value, vallen);
+
+            return (size_t)(tmp_buffer - buffer);
+        }
+
+        if (size < sizeof(size_t))
+        {
+            SWSS_LOG_THROW("serialized data was truncated, size: %zu", size);
+        }
+
+        WARNINGS_NO_CAST_ALIGN;
+        size_t kvp_count = *(const size_t*)buffer;
+        WARNINGS_RESET;
+
+        if (kvp_count == 0)
+        {
+            SWSS_LOG_THROW("serialized data has no header");
+        }
+
+        const char* tmp_buffer = buffer + sizeof(size_t);
+        readKeyAndValue(buffer, size, tmp_buffer, key, keylen, value, vallen);
+
+        return (size_t)(tmp_buffer - buffer);
+    }
+
+    static size_t readHeader(const char* buffer, const size_t size)
+    {
+        const char* key;
+        size_t keylen;
+        const char* value;
+        size_t vallen;
+        return readHeader(buffer, size, key, keylen, value, vallen);
+    }
+
+    static void readKeyAndValue(
+        const char* buffer,
+        const size_t size,
+        const char*& tmp_buffer,
+        const char*& key,
+        size_t& keylen,
+        const char*& value,
+        size_t& vallen)
+    {
+        readData(buffer, size, tmp_buffer, key, keylen);
+        readData(buffer, size, tmp_buffer, value, vallen);
+    }
+
+    static void readData(
+        const char* buffer,
+        const size_t size,
+        const char*& tmp_buffer,
+        const char*& data,
+        size_t& datalen)
+    {
+        if ((size_t)(tmp_buffer - buffer) + sizeof(size_t) > size)
+        {
+            SWSS_LOG_THROW("serialized length was truncated, increase buffer size: %zu", size);
+        }
+
+        WARNINGS_NO_CAST_ALIGN;
+        datalen = *(const size_t*)tmp_buffer;
+        WARNINGS_RESET;
+
+        tmp_buffer += sizeof(size_t);
+        if (datalen > size - (size_t)(tmp_buffer - buffer))
+        {
+            SWSS_LOG_THROW("serialized data was truncated, data length: %zu, increase buffer size: %zu",
+                                                                                            datalen,
+                                                                                            size);
+        }
+
+        data = tmp_buffer;
+        tmp_buffer += datalen;
+    }
+
+    static constexpr uint32_t WIRE_MAGIC = 0x42535753; // "SWSB"
+    static constexpr size_t WIRE_PREAMBLE_SIZE = sizeof(uint32_t) + 1;
+    static constexpr uint8_t WIRE_OP_SET = 1;
+    static constexpr uint8_t WIRE_OP_DEL = 2;
+    static constexpr uint8_t WIRE_OP_OTHER = 3;
+
+    // Version 2 field name -> reference, keyed by the names in the batch
+    // being serialized, so no name is copied.
+    struct FieldNameHash
+    {
+        size_t operator()(const std::string* name) const { return std::hash<std::string>()(*name); }
+    };
+
+    struct FieldNameEqual
+    {
+        bool operator()(const std::string* a, const std::string* b) const { return *a == *b; }
+    };
+
+    typedef std::unordered_map<const std::string*, uint64_t, FieldNameHash, FieldNameEqual> FieldDictionary;
+
+    // true when the name is new to the message, the reference is the existing one otherwise
+    static bool addFieldName(FieldDictionary& dictionary, const std::string& name, uint64_t& reference)
+    {
+        auto result = dictionary.emplace(&name, (uint64_t)dictionary.size() + 1);
+        reference = result.first->second;
+        return result.second;
+    }
+
+    static uint8_t toWireOp(const std::string& op)
+    {
+        switch (KeyOpFieldsValuesEntry::toOp(op))
+        {
+            case KeyOpFieldsValuesEntry::Op::SET:
+                return WIRE_OP_SET;
+            case KeyOpFieldsValuesEntry::Op::DEL:
+                return WIRE_OP_DEL;
+            default:
+                return WIRE_OP_OTHER;
+        }
+    }
+
+    static size_t varintLength(uint64_t value)
+    {
+        size_t length = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            length++;
+        }
+
+        return length;
+    }
+
+    static size_t stringLength(const std::string& data)
+    {
+        return varintLength(data.length()) + data.length();
+    }
+
+    static size_t serializedSizeV2(
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos)
+    {
+        size_t size = WIRE_PREAMBLE_SIZE + stringLength(dbName) + stringLength(tableName) + varintLength(kcos.size());
+
+        FieldDictionary dictionary;
+        for (auto& kco : kcos)
+        {
+            auto& fvs = kfvFieldsValues(kco);
+            size += 1 + stringLength(kfvKey(kco)) + varintLength(fvs.size());
+            if (toWireOp(kfvOp(kco)) == WIRE_OP_OTHER)
+            {
+                size += stringLength(kfvOp(kco));
+            }
+
+            for (auto& fv : fvs)
+            {
+                uint64_t reference;
+                if (addFieldName(dictionary, fvField(fv), reference))
+                {
+                    size += 1 + stringLength(fvField(fv));
+                }
+                else
+                {
+                    size += varintLength(reference);
+                }
+
+                size += stringLength(fvValue(fv));
+            }
+        }
+
+        return size;
+    }
+
+    static size_t serializeBufferV2(
+        const char* buffer,
+        const size_t size,
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos)
+    {
+        char* position = const_cast<char*>(buffer);
+        const char* end = buffer + size;
+        if (size < WIRE_PREAMBLE_SIZE)
+        {
+            SWSS_LOG_THROW("There are not enough buffer for binary serializer to serialize, buffer size: %zu", size);
+        }
+
+        uint32_t magic = WIRE_MAGIC;
+        memcpy(position, &magic, sizeof(magic));
+        position[sizeof(magic)] = (char)WIRE_VERSION_2;
+        position += WIRE_PREAMBLE_SIZE;
+
+        writeString(position, end, dbName);
+        writeString(position, end, tableName);
+        writeVarint(position, end, kcos.size());
+
+        FieldDictionary dictionary;
+        for (auto& kco : kcos)
+        {
+            auto& fvs = kfvFieldsValues(kco);
+            uint8_t op = toWireOp(kfvOp(kco));
+            writeVarint(position, end, op);
+            if (op == WIRE_OP_OTHER)
+            {
+                writeString(position, end, kfvOp(kco));
+            }
+
+            writeString(position, end, kfvKey(kco));
+            writeVarint(position, end, fvs.size());
+            for (auto& fv : fvs)
+            {
+                uint64_t reference;
+                if (addFieldName(dictionary, fvField(fv), reference))
+                {
+                    writeVarint(position, end, 0);
+                    writeString(position, end, fvField(fv));
+                }
+                else
+                {
+                    writeVarint(position, end, reference);
+                }
+
+                writeString(position, end, fvValue(fv));
+            }
+        }
+
+        return (size_t)(position - buffer);
+    }
+
+    static void writeVarint(char*& position, const char* end, uint64_t value)
+    {
+        if ((size_t)(end - position) < varintLength(value))
+        {
+            SWSS_LOG_THROW("There are not enough buffer for binary serializer to serialize, %zu bytes left", (size_t)(end - position));
+        }
+
+        do
+        {
+            uint8_t byte = (uint8_t)(value & 0x7f);
+            value >>= 7;
+            if (value != 0)
+            {
+                byte = (uint8_t)(byte | 0x80);
+            }
+
+            *position++ = (char)byte;
+        } while (value != 0);
+    }
+
+    static void writeString(char*& position, const char* end, const std::string& data)
+    {
+        writeVarint(position, end, data.length());
+        if ((size_t)(end - position) < data.length())
+        {
+            SWSS_LOG_THROW("There are not enough buffer for binary serializer to serialize, data length %zu, %zu bytes left",
+                                                data.length(),
+                                                (size_t)(end - position));
+        }
+
+        memcpy(position, data.c_str(), data.length());
+        position += data.length();
+    }
+
+    static uint64_t readVarint(
+        const char* buffer,
+        const size_t size,
+        const char*& tmp_buffer)
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if ((size_t)(tmp_buffer - buffer) >= size)
+            {
+                SWSS_LOG_THROW("serialized varint was truncated, increase buffer size: %zu", size);
+            }
+
+            uint8_t byte = (uint8_t)*tmp_buffer++;
+            if (shift == 63 && byte > 1)
+            {
+                break;
+            }
+
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+
+        SWSS_LOG_THROW("serialized varint is too long");
+    }
+
+    static void readString(
+        const char* buffer,
+        const size_t size,
+        const char*& tmp_buffer,
+        const char*& data,
+        size_t& datalen)
+    {
+        uint64_t length = readVarint(buffer, size, tmp_buffer);
+        if (length > size - (size_t)(tmp_buffer - buffer))
+        {
+            SWSS_LOG_THROW("serialized data was truncated, data length: %" PRIu64 ", increase buffer size: %zu", length, size);
+        }
+
+        data = tmp_buffer;
+        datalen = (size_t)length;
+        tmp_buffer += datalen;
+    }
+
+    static void deserializeBufferV2(
+        const char* buffer,
+        const size_t size,
+        std::string& dbName,
+        std::string& tableName,
+        std::vector<KeyOpFieldsValuesEntry>& entries)
+    {
+        const char* tmp_buffer = buffer + WIRE_PREAMBLE_SIZE;
+        const char* data;
+        size_t datalen;
+
+        readString(buffer, size, tmp_buffer, data, datalen);
+        dbName.assign(data, datalen);
+        readString(buffer, size, tmp_buffer, data, datalen);
+        tableName.assign(data, datalen);
+
+        // an entry takes at least 3 bytes, a field at least 2, which bounds
+        // the counts of a corrupted message before anything is reserved
+        uint64_t count = readVarint(buffer, size, tmp_buffer);
+        if (count > (size - (size_t)(tmp_buffer - buffer)) / 3)
+        {
+            SWSS_LOG_THROW("serialized entry count %" PRIu64 " exceeds the buffer size: %zu", count, size);
+        }
+
+        // field names point into the buffer
+        std::vector<std::pair<const char*, size_t>> dictionary;
+        entries.reserve(entries.size() + (size_t)count);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t op = readVarint(buffer, size, tmp_buffer);
+            const char* opString = nullptr;
+            size_t opLength = 0;
+            if (op == WIRE_OP_OTHER)
+            {
+                readString(buffer, size, tmp_buffer, opString, opLength);
+            }
+            else if (op != WIRE_OP_SET && op != WIRE_OP_DEL)
+            {
+                SWSS_LOG_THROW("serialized op code %" PRIu64 " is unknown", op);
+            }
+
+            readString(buffer, size, tmp_buffer, data, datalen);
+            entries.emplace_back();
+            auto& entry = entries.back();
+            if (op == WIRE_OP_OTHER)
+            {
+                entry.reset(data, datalen, std::string(opString, opLength));
+            }
+            else
+            {
+                entry.reset(data, datalen, (op == WIRE_OP_SET) ? KeyOpFieldsValuesEntry::Op::SET : KeyOpFieldsValuesEntry::Op::DEL);
+            }
+
+            uint64_t fieldCount = readVarint(buffer, size, tmp_buffer);
+            if (fieldCount > (size - (size_t)(tmp_buffer - buffer)) / 2)
+            {
+                SWSS_LOG_THROW("serialized field count %" PRIu64 " exceeds the buffer size: %zu", fieldCount, size);
+            }
+
+            for (uint64_t j = 0; j < fieldCount; j++)
+            {
+                uint64_t reference = readVarint(buffer, size, tmp_buffer);
+                if (reference == 0)
+                {
+                    readString(buffer, size, tmp_buffer, data, datalen);
+                    dictionary.emplace_back(data, datalen);
+                    reference = dictionary.size();
+                }
+                else if (reference > dictionary.size())
+                {
+                    SWSS_LOG_THROW("serialized field name reference %" PRIu64 " exceeds the %zu names", reference, dictionary.size());
+                }
+
+                auto& name = dictionary[(size_t)reference - 1];
+                readString(buffer, size, tmp_buffer, data, datalen);
+                entry.addField(name.first, name.second, data, datalen);
+            }
+        }
+    }
+
+    // the version 1 pairs of a version 2 body, for the pair deserializer
+    static void flattenV2(
+        const char* buffer,
+        const size_t size,
+        std::vector<swss::FieldValueTuple>& values)
+    {
+        std::string dbName;
+        std::string tableName;
+        std::vector<KeyOpFieldsValuesEntry> entries;
+        deserializeBufferV2(buffer, size, dbName, tableName, entries);
+
+        values.emplace_back(dbName, tableName);
+        for (auto& entry : entries)
+        {
+            values.emplace_back(entry.getKey(), std::to_string(entry.getFieldCount()));
+            for (size_t i = 0; i < entry.getFieldCount(); i++)
+            {
+                values.emplace_back(entry.getField(i), entry.getValue(i));
+            }
+        }
+    }
+
+    // length of the decimal attribute count written by serializeBuffer()
+    static size_t countLength(size_t count)
+    {
+        size_t length = 1;
+        while (count >= 10)
+        {
+            count /= 10;
+            length++;
+        }
+
+        return length;
+    }
+
+    static size_t parseCount(const char* data, size_t datalen)
+    {
+        if (datalen == 0)
+        {
+            SWSS_LOG_THROW("serialized attribute count is empty");
+        }
+
+        size_t count = 0;
+        for (size_t i = 0; i < datalen; i++)
+        {
+            if (data[i] < '0' || data[i] > '9')
+            {
+                SWSS_LOG_THROW("serialized attribute count is not a number: %s", std::string(data, datalen).c_str());
+            }
+
+            count = count * 10 + (size_t)(data[i] - '0');
+        }
+
+        return count;
+    }
+
     const char* m_buffer;
     const size_t m_buffer_size;
     char* m_current_position;
@@ -54,11 +54,19 @@ void ConsumerStateTable::pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const st
     // if the set is empty, return an empty kco object
     if (ctx0->type == REDIS_REPLY_NIL)
     {
+        collapseQueue(0);
         return;
     }
 
     assert(ctx0->type == REDIS_REPLY_ARRAY);
     size_t n = ctx0->elements;
+
+    // pop() hands out one buffered entry per select(), it still needs one
+    // notification per key
+    if (&vkco != &m_buffer)
+    {
+        collapseQueue(n);
+    }
     vkco.resize(n);
     for (size_t ie = 0; ie < n; ie++)
     {
@@ -68,17 +76,16 @@ void ConsumerStateTable::pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const st
 
         auto& ctx = ctx0->element[ie];
         assert(ctx->element[0]->type == REDIS_REPLY_STRING);
-        std::string key(ctx->element[0]->str, ctx->element[0]->len);
-        kfvKey(kco) = key;
+        kfvKey(kco).assign(ctx->element[0]->str, ctx->element[0]->len);
 
         assert(ctx->element[1]->type == REDIS_REPLY_ARRAY);
         auto ctx1 = ctx->element[1];
+        values.reserve(ctx1->elements / 2);
         for (size_t i = 0; i < ctx1->elements / 2; i++)
         {
-            FieldValueTuple e;
-            fvField(e).assign(ctx1->element[i * 2]->str, ctx1->element[i * 2]->len);
-            fvValue(e).assign(ctx1->element[i * 2 + 1]->str, ctx1->element[i * 2 + 1]->len);
-            values.push_back(e);
+            values.emplace_back(
+                            std::string(ctx1->element[i * 2]->str, ctx1->element[i * 2]->len),
+                            std::string(ctx1->element[i * 2 + 1]->str, ctx1->element[i * 2 + 1]->len));
         }
 
         // if there is no field-value pair, the key is already deleted
@@ -93,4 +100,21 @@ void ConsumerStateTable::pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const st
     }
 }
 
+void ConsumerStateTable::collapseQueue(size_t popped)
+{
+    // a short batch drained the key set, every queued notification is served
+    if (popped < static_cast<size_t>(POP_BATCH_SIZE))
+    {
+        collapseQueueLength(0);
+        return;
+    }
+
+    RedisCommand scard;
+    scard.format("SCARD %s", getKeySetName().c_str());
+    RedisReply r(m_db, scard, REDIS_REPLY_INTEGER);
+
+    long long int remaining = r.getReply<long long int>();
+    collapseQueueLength((remaining + POP_BATCH_SIZE - 1) / POP_BATCH_SIZE);
+}
+
 }
@@ -16,6 +16,9 @@ public:
     void pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const std::string &prefix = EMPTY_PREFIX);
 
 private:
+    /* Resync the queued notifications with the keys left after a pop */
+    void collapseQueue(size_t popped);
+
     std::string m_shaPop;
 };
 
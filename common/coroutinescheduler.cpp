@@ -0,0 +1,234 @@
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include "common/logger.h"
+#include "common/coroutinescheduler.h"
+
+using namespace std;
+
+namespace swss {
+
+// scheduler resuming a coroutine for the first time, read by trampoline()
+static thread_local CoroutineScheduler *s_starting = nullptr;
+
+CoroutineScheduler::CoroutineScheduler(size_t stackSize)
+    : m_stackSize(stackSize)
+    , m_running(nullptr)
+{
+}
+
+CoroutineScheduler::~CoroutineScheduler()
+{
+}
+
+CoroutineScheduler::Coroutine::~Coroutine()
+{
+    if (stack != nullptr)
+    {
+        munmap(stack, mappedSize);
+    }
+}
+
+void CoroutineScheduler::spawn(Routine routine)
+{
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t stackSize = (m_stackSize + pageSize - 1) / pageSize * pageSize;
+
+    unique_ptr<Coroutine> coroutine(new Coroutine());
+    void *addr = mmap(NULL, stackSize + pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (addr == MAP_FAILED)
+    {
+        SWSS_LOG_THROW("mmap of coroutine stack failed, errno: %s", strerror(errno));
+    }
+
+    coroutine->stack = static_cast<char *>(addr);
+    coroutine->mappedSize = stackSize + pageSize;
+
+    // the stack grows down, an overflow faults on the guard page below it
+    if (mprotect(coroutine->stack, pageSize, PROT_NONE) == -1)
+    {
+        SWSS_LOG_THROW("mprotect of coroutine stack guard failed, errno: %s", strerror(errno));
+    }
+
+    coroutine->routine = routine;
+    coroutine->done = false;
+
+    if (getcontext(&coroutine->context) == -1)
+    {
+        SWSS_LOG_THROW("getcontext failed, errno: %s", strerror(errno));
+    }
+
+    coroutine->context.uc_stack.ss_sp = coroutine->stack + pageSize;
+    coroutine->context.uc_stack.ss_size = stackSize;
+    coroutine->context.uc_link = &m_mainContext;
+    makecontext(&coroutine->context, &CoroutineScheduler::trampoline, 0);
+
+    m_runnable.push_back(coroutine.get());
+    m_coroutines.push_back(move(coroutine));
+}
+
+int CoroutineScheduler::run(int timeout)
+{
+    SWSS_LOG_ENTER();
+
+    vector<Selectable *> ready;
+
+    while (true)
+    {
+        while (!m_runnable.empty())
+        {
+            Coroutine *coroutine = m_runnable.front();
+            m_runnable.pop_front();
+
+            resume(coroutine);
+            if (!coroutine->done)
+            {
+                continue;
+            }
+
+            auto error = coroutine->error;
+            m_coroutines.erase(find_if(m_coroutines.begin(), m_coroutines.end(),
+                    [coroutine](const unique_ptr<Coroutine> &c) { return c.get() == coroutine; }));
+
+            if (error)
+            {
+                rethrow_exception(error);
+            }
+        }
+
+        if (m_coroutines.empty())
+        {
+            return Select::OBJECT;
+        }
+
+        int ret = m_select.selectMany(ready, timeout);
+        if (ret != Select::OBJECT)
+        {
+            return ret;
+        }
+
+        for (auto sel : ready)
+        {
+            auto &waiters = m_waiters[sel];
+            if (waiters.queue.empty())
+            {
+                // keep the wakeup for the next wait(), stop polling until then
+                waiters.pending++;
+                m_select.removeSelectable(sel);
+                waiters.registered = false;
+                continue;
+            }
+
+            m_runnable.push_back(waiters.queue.front());
+            waiters.queue.pop_front();
+        }
+    }
+}
+
+void CoroutineScheduler::wait(Selectable *selectable)
+{
+    Coroutine *coroutine = current();
+
+    auto &waiters = m_waiters[selectable];
+    if (waiters.pending > 0)
+    {
+        waiters.pending--;
+        return;
+    }
+
+    if (!waiters.registered)
+    {
+        m_select.addSelectable(selectable);
+        if (selectable->hasCachedData())
+        {
+            m_select.pushReady(selectable);
+        }
+        waiters.registered = true;
+    }
+
+    waiters.queue.push_back(coroutine);
+    suspend();
+}
+
+void CoroutineScheduler::yield()
+{
+    m_runnable.push_back(current());
+    suspend();
+}
+
+void CoroutineScheduler::removeSelectable(Selectable *selectable)
+{
+    auto it = m_waiters.find(selectable);
+    if (it == m_waiters.end())
+    {
+        return;
+    }
+
+    if (!it->second.queue.empty())
+    {
+        SWSS_LOG_THROW("Selectable is still waited for");
+    }
+
+    if (it->second.registered)
+    {
+        m_select.removeSelectable(selectable);
+    }
+
+    m_waiters.erase(it);
+}
+
+void CoroutineScheduler::trampoline()
+{
+    CoroutineScheduler *scheduler = s_starting;
+    Coroutine *coroutine = scheduler->m_running;
+
+    try
+    {
+        coroutine->routine();
+    }
+    catch (...)
+    {
+        coroutine->error = current_exception();
+    }
+
+    coroutine->done = true;
+
+    // returning switches to uc_link, the context of run()
+}
+
+void CoroutineScheduler::resume(Coroutine *coroutine)
+{
+    m_running = coroutine;
+    s_starting = this;
+
+    if (swapcontext(&m_mainContext, &coroutine->context) == -1)
+    {
+        m_running = nullptr;
+        SWSS_LOG_THROW("swapcontext failed, errno: %s", strerror(errno));
+    }
+
+    m_running = nullptr;
+}
+
+void CoroutineScheduler::suspend()
+{
+    Coroutine *coroutine = current();
+
+    if (swapcontext(&coroutine->context, &m_mainContext) == -1)
+    {
+        SWSS_LOG_THROW("swapcontext failed, errno: %s", strerror(errno));
+    }
+}
+
+CoroutineScheduler::Coroutine *CoroutineScheduler::current()
+{
+    if (m_running == nullptr)
+    {
+        SWSS_LOG_THROW("not called from a coroutine");
+    }
+
+    return m_running;
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <unordered_map>
+#include <ucontext.h>
+#include "select.h"
+
+namespace swss {
+
+/*
+ * Cooperative coroutines driven by a Select loop on the calling thread.
+ *
+ * Every coroutine runs on its own stack. wait() suspends the running
+ * coroutine until Select reports the selectable as ready, so a consumer
+ * reads like straight line code:
+ *
+ *     scheduler.spawn([&]() {
+ *         while (true)
+ *         {
+ *             scheduler.wait(&table);
+ *             table.pops(entries);
+ *             ...
+ *         }
+ *     });
+ *     scheduler.run();
+ *
+ * A selectable is registered in the Select while a coroutine waits for it.
+ * When it becomes ready with nobody waiting, the wakeup is remembered and
+ * the next wait() returns right away. Waiters of one selectable are resumed
+ * in FIFO order, one per wakeup.
+ *
+ * Coroutines are stackful, the stack size has to cover the deepest call
+ * chain inside the coroutine. The size is rounded up to whole pages and a
+ * guard page below every stack turns an overflow into a SIGSEGV instead of
+ * silent memory corruption. Coroutines that didn't return when the
+ * scheduler is destroyed are dropped without unwinding their stacks.
+ */
+class CoroutineScheduler
+{
+public:
+    typedef std::function<void()> Routine;
+
+    static constexpr size_t DEFAULT_STACK_SIZE = 256 * 1024;
+
+    CoroutineScheduler(size_t stackSize = DEFAULT_STACK_SIZE);
+    ~CoroutineScheduler();
+
+    /* Create a coroutine, it starts running from run() */
+    void spawn(Routine routine);
+
+    /*
+     * Resume coroutines until all of them returned, returns OBJECT then.
+     * Returns the result of select() when it is TIMEOUT, ERROR or SIGNALINT.
+     * An exception thrown by a coroutine is rethrown from here.
+     */
+    int run(int timeout = -1);
+
+    /* Suspend the running coroutine until the selectable is ready */
+    void wait(Selectable *selectable);
+
+    /* Let the other runnable coroutines run first */
+    void yield();
+
+    /* Forget a selectable, call it before a waited for selectable is destroyed */
+    void removeSelectable(Selectable *selectable);
+
+    /* Number of coroutines that didn't return yet */
+    size_t getCoroutineCount() const
+    {
+        return m_coroutines.size();
+    }
+
+private:
+    struct Coroutine
+    {
+        ~Coroutine();
+
+        ucontext_t context;
+        char *stack = nullptr; // guard page followed by the stack
+        size_t mappedSize = 0;
+        Routine routine;
+        bool done;
+        std::exception_ptr error;
+    };
+
+    struct Waiters
+    {
+        std::deque<Coroutine *> queue;
+        size_t pending = 0; // wakeups that nobody waited for
+        bool registered = false;
+    };
+
+    static void trampoline();
+
+    void resume(Coroutine *coroutine);
+
+    void suspend();
+
+    Coroutine *current();
+
+    size_t m_stackSize;
+
+    Select m_select;
+
+    ucontext_t m_mainContext;
+
+    Coroutine *m_running;
+
+    std::deque<Coroutine *> m_runnable;
+
+    std::unordered_map<Selectable *, Waiters> m_waiters;
+
+    std::vector<std::unique_ptr<Coroutine>> m_coroutines;
+};
+
+}
@@ -0,0 +1,166 @@
+#include <string>
+#include <vector>
+#include "keyopfieldsvaluesentry.h"
+
+using namespace std;
+
+namespace swss {
+
+KeyOpFieldsValuesEntry::KeyOpFieldsValuesEntry()
+    : m_keyLength(0)
+    , m_opLength(0)
+    , m_op(Op::SET)
+{
+}
+
+KeyOpFieldsValuesEntry::KeyOpFieldsValuesEntry(const string &key, Op op)
+    : KeyOpFieldsValuesEntry()
+{
+    reset(key.c_str(), key.length(), op);
+}
+
+KeyOpFieldsValuesEntry::KeyOpFieldsValuesEntry(const KeyOpFieldsValuesTuple &kco)
+    : KeyOpFieldsValuesEntry()
+{
+    auto& key = kfvKey(kco);
+    auto& fvs = kfvFieldsValues(kco);
+
+    size_t bytes = key.length() + kfvOp(kco).length();
+    for (auto& fv : fvs)
+    {
+        bytes += fvField(fv).length() + fvValue(fv).length();
+    }
+
+    reset(key.c_str(), key.length(), kfvOp(kco));
+    reserve(fvs.size(), bytes);
+    for (auto& fv : fvs)
+    {
+        addField(fvField(fv), fvValue(fv));
+    }
+}
+
+void KeyOpFieldsValuesEntry::reset(const char *key, size_t keylen, Op op)
+{
+    m_data.assign(key, keylen);
+    m_keyLength = keylen;
+    m_opLength = 0;
+    m_op = op;
+    m_fields.clear();
+}
+
+void KeyOpFieldsValuesEntry::reset(const char *key, size_t keylen, const string &op)
+{
+    reset(key, keylen, toOp(op));
+    if (m_op == Op::OTHER)
+    {
+        m_data.append(op);
+        m_opLength = op.length();
+    }
+}
+
+void KeyOpFieldsValuesEntry::reserve(size_t fieldCount, size_t bytes)
+{
+    m_data.reserve(bytes);
+    m_fields.reserve(fieldCount);
+}
+
+void KeyOpFieldsValuesEntry::addField(const char *field, size_t fieldlen, const char *value, size_t valuelen)
+{
+    FieldSlice slice;
+    slice.offset = m_data.length();
+    slice.fieldLength = fieldlen;
+    slice.valueLength = valuelen;
+
+    m_data.append(field, fieldlen);
+    m_data.append(value, valuelen);
+    m_fields.push_back(slice);
+}
+
+void KeyOpFieldsValuesEntry::addField(const string &field, const string &value)
+{
+    addField(field.c_str(), field.length(), value.c_str(), value.length());
+}
+
+string KeyOpFieldsValuesEntry::getKey() const
+{
+    return m_data.substr(0, m_keyLength);
+}
+
+string KeyOpFieldsValuesEntry::getOpString() const
+{
+    if (m_op == Op::OTHER)
+    {
+        return m_data.substr(m_keyLength, m_opLength);
+    }
+
+    return toOpString(m_op);
+}
+
+string KeyOpFieldsValuesEntry::getField(size_t index) const
+{
+    auto& slice = m_fields[index];
+    return m_data.substr(slice.offset, slice.fieldLength);
+}
+
+string KeyOpFieldsValuesEntry::getValue(size_t index) const
+{
+    auto& slice = m_fields[index];
+    return m_data.substr(slice.offset + slice.fieldLength, slice.valueLength);
+}
+
+KeyOpFieldsValuesTuple KeyOpFieldsValuesEntry::toTuple() const
+{
+    KeyOpFieldsValuesTuple kco;
+    toTuple(kco);
+    return kco;
+}
+
+void KeyOpFieldsValuesEntry::toTuple(KeyOpFieldsValuesTuple &kco) const
+{
+    const char *data = m_data.data();
+
+    kfvKey(kco).assign(data, m_keyLength);
+    kfvOp(kco) = getOpString();
+
+    auto& fvs = kfvFieldsValues(kco);
+    fvs.clear();
+    fvs.reserve(m_fields.size());
+    for (auto& slice : m_fields)
+    {
+        const char *field = data + slice.offset;
+        fvs.emplace_back(
+                        string(field, slice.fieldLength),
+                        string(field + slice.fieldLength, slice.valueLength));
+    }
+}
+
+KeyOpFieldsValuesEntry::Op KeyOpFieldsValuesEntry::toOp(const string &op)
+{
+    if (op == SET_COMMAND)
+    {
+        return Op::SET;
+    }
+    else if (op == DEL_COMMAND)
+    {
+        return Op::DEL;
+    }
+
+    return Op::OTHER;
+}
+
+string KeyOpFieldsValuesEntry::toOpString(Op op)
+{
+    switch (op)
+    {
+        case Op::SET:
+            return SET_COMMAND;
+
+        case Op::DEL:
+            return DEL_COMMAND;
+
+        default:
+            return "";
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "table.h"
+#include "smallvector.h"
+
+namespace swss {
+
+/*
+ * Compact alternative to KeyOpFieldsValuesTuple.
+ *
+ * The key, the field names and the values are packed back to back into a
+ * single string buffer, the operation is stored as an enum, and the field
+ * offsets are kept in a small vector with inline room for a few fields.
+ * A typical entry costs one heap allocation instead of one per string plus
+ * one for the field vector, which makes queues of pending updates much more
+ * cache friendly. Use toTuple() to hand the entry to legacy consumers.
+ */
+class KeyOpFieldsValuesEntry
+{
+public:
+    enum class Op : uint8_t
+    {
+        SET,
+        DEL,
+        OTHER, // op string is stored in the buffer after the key
+    };
+
+    static constexpr size_t INLINE_FIELD_COUNT = 4;
+
+    KeyOpFieldsValuesEntry();
+
+    KeyOpFieldsValuesEntry(const std::string &key, Op op);
+
+    explicit KeyOpFieldsValuesEntry(const KeyOpFieldsValuesTuple &kco);
+
+    /* Drop all content and start a new entry */
+    void reset(const char *key, size_t keylen, Op op);
+    void reset(const char *key, size_t keylen, const std::string &op);
+
+    /* Pre-allocate room for the given number of fields and payload bytes */
+    void reserve(size_t fieldCount, size_t bytes);
+
+    void addField(const char *field, size_t fieldlen, const char *value, size_t valuelen);
+    void addField(const std::string &field, const std::string &value);
+
+    std::string getKey() const;
+    std::string getOpString() const;
+    Op getOp() const { return m_op; }
+
+    size_t getFieldCount() const { return m_fields.size(); }
+    std::string getField(size_t index) const;
+    std::string getValue(size_t index) const;
+
+    /* Convert to the legacy tuple representation */
+    KeyOpFieldsValuesTuple toTuple() const;
+    void toTuple(KeyOpFieldsValuesTuple &kco) const;
+
+    static Op toOp(const std::string &op);
+    static std::string toOpString(Op op);
+
+private:
+    struct FieldSlice
+    {
+        size_t offset; // field name offset in m_data, value follows the name
+        size_t fieldLength;
+        size_t valueLength;
+    };
+
+    std::string m_data;
+
+    size_t m_keyLength;
+
+    size_t m_opLength;
+
+    Op m_op;
+
+    SmallVector<FieldSlice, INLINE_FIELD_COUNT> m_fields;
+};
+
+}
@@ -0,0 +1,131 @@
+#include <string>
+#include <algorithm>
+#include <hiredis/hiredis.h>
+#include "dbconnector.h"
+#include "redisreply.h"
+#include "redisselect.h"
+#include "subscriberstatetable.h"
+#include "keyspacedispatcher.h"
+
+using namespace std;
+
+namespace swss {
+
+KeyspaceDispatcher::KeyspaceDispatcher(DBConnector *db, int pri)
+    : RedisSelect(pri)
+    , m_dbId(db->getDbId())
+    , m_separator(SonicDBConfig::getSeparator(db))
+{
+    m_keyspace = "__keyspace@" + to_string(m_dbId) + "__:*";
+
+    psubscribe(db, m_keyspace);
+
+    SWSS_LOG_DEBUG("KeyspaceDispatcher ctor pattern: %s", m_keyspace.c_str());
+}
+
+KeyspaceDispatcher::~KeyspaceDispatcher()
+{
+    for (auto &it : m_tables)
+    {
+        for (auto table : it.second)
+        {
+            table->detachDispatcher();
+        }
+    }
+}
+
+void KeyspaceDispatcher::registerTable(const string &tableName, SubscriberStateTable *table)
+{
+    m_tables[tableName].push_back(table);
+
+    SWSS_LOG_DEBUG("KeyspaceDispatcher register table: %s", tableName.c_str());
+}
+
+void KeyspaceDispatcher::unregisterTable(const string &tableName, SubscriberStateTable *table)
+{
+    auto it = m_tables.find(tableName);
+    if (it == m_tables.end())
+    {
+        return;
+    }
+
+    auto &tables = it->second;
+    tables.erase(remove(tables.begin(), tables.end(), table), tables.end());
+    if (tables.empty())
+    {
+        m_tables.erase(it);
+    }
+}
+
+uint64_t KeyspaceDispatcher::readData()
+{
+    redisReply *reply = nullptr;
+
+    /* Read data from redis. This call is non blocking. This method
+     * is called from Select framework when data is available in socket.
+     * NOTE: Keyspace events are not persistent, every event read here
+     * must be routed right away. */
+    if (redisGetReply(m_subscribe->getContext(), reinterpret_cast<void**>(&reply)) != REDIS_OK)
+    {
+        throw std::runtime_error("Unable to read redis reply");
+    }
+
+    dispatch(make_shared<RedisReply>(reply));
+
+    reply = nullptr;
+    int status;
+    do
+    {
+        status = redisGetReplyFromReader(m_subscribe->getContext(), reinterpret_cast<void**>(&reply));
+        if(reply != nullptr && status == REDIS_OK)
+        {
+            dispatch(make_shared<RedisReply>(reply));
+        }
+    }
+    while(reply != nullptr && status == REDIS_OK);
+
+    if (status != REDIS_OK)
+    {
+        throw std::runtime_error("Unable to read redis reply");
+    }
+    return 0;
+}
+
+void KeyspaceDispatcher::dispatch(const shared_ptr<RedisReply> &event)
+{
+    auto message = event->getReply<RedisMessage>();
+    if (message.type.empty() || message.pattern != m_keyspace)
+    {
+        return;
+    }
+
+    /* Channel is __keyspace@N__:<table><separator><key> */
+    const string &channel = message.channel;
+    size_t begin = channel.find(':');
+    if (begin == channel.npos)
+    {
+        SWSS_LOG_ERROR("invalid format %s returned for pmessage of %s", channel.c_str(), m_keyspace.c_str());
+        return;
+    }
+
+    begin++;
+    size_t end = channel.find(m_separator, begin);
+    if (end == channel.npos)
+    {
+        // Not a table entry
+        return;
+    }
+
+    auto it = m_tables.find(channel.substr(begin, end - begin));
+    if (it == m_tables.end())
+    {
+        return;
+    }
+
+    for (auto table : it->second)
+    {
+        table->pushKeyspaceEvent(event);
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "dbconnector.h"
+#include "redisselect.h"
+
+namespace swss {
+
+class SubscriberStateTable;
+
+/*
+ * Single keyspace subscription shared by many SubscriberStateTables of one DB.
+ *
+ * The dispatcher holds one subscriber connection and one PSUBSCRIBE on
+ * __keyspace@N__:*, and routes every event to the tables registered for the
+ * table name with a hash lookup. Redis then matches one pattern per write
+ * instead of one per table, and the daemon needs one redis connection per DB.
+ *
+ * The dispatcher has to be added to the Select together with its tables. It is
+ * never returned by Select::select(), the tables become ready instead.
+ *
+ * Tables unregister themselves when destroyed. Destroy the dispatcher after
+ * its tables, a dispatcher destroyed first detaches the tables still
+ * registered, they stay valid but receive no more keyspace events.
+ */
+class KeyspaceDispatcher : public RedisSelect
+{
+public:
+    KeyspaceDispatcher(DBConnector *db, int pri = 0);
+
+    ~KeyspaceDispatcher() override;
+
+    /* Read keyspace events from redis and route them to the registered tables */
+    uint64_t readData() override;
+
+    bool hasData() override
+    {
+        return false;
+    }
+
+    bool hasCachedData() override
+    {
+        return false;
+    }
+
+    bool initializedWithData() override
+    {
+        return false;
+    }
+
+    void updateAfterRead() override
+    {
+    }
+
+    const std::string &getKeyspacePattern() const
+    {
+        return m_keyspace;
+    }
+
+    int getDbId() const
+    {
+        return m_dbId;
+    }
+
+private:
+    friend class SubscriberStateTable;
+
+    void registerTable(const std::string &tableName, SubscriberStateTable *table);
+
+    void unregisterTable(const std::string &tableName, SubscriberStateTable *table);
+
+    void dispatch(const std::shared_ptr<RedisReply> &event);
+
+    int m_dbId;
+
+    std::string m_keyspace;
+
+    std::string m_separator;
+
+    std::unordered_map<std::string, std::vector<SubscriberStateTable *>> m_tables;
+};
+
+}
@@ -0,0 +1,249 @@
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include "common/logger.h"
+#include "common/lzcodec.h"
+
+namespace swss {
+
+static const size_t LZ_MIN_MATCH = 4;
+static const size_t LZ_MAX_OFFSET = 65535;
+static const int LZ_HASH_BITS = 14;
+
+// the last bytes of the input are always literals
+static const size_t LZ_END_LITERALS = 5;
+
+static inline uint32_t read32(const char *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash32(uint32_t value)
+{
+    return (value * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+static bool writeLength(char *&op, const char *oend, size_t length)
+{
+    while (length >= 255)
+    {
+        if (op >= oend)
+        {
+            return false;
+        }
+
+        *op++ = (char)255;
+        length -= 255;
+    }
+
+    if (op >= oend)
+    {
+        return false;
+    }
+
+    *op++ = (char)length;
+    return true;
+}
+
+// matchLength 0 writes the last sequence, literals only
+static bool writeSequence(
+        char *&op,
+        const char *oend,
+        const char *literals,
+        size_t literalLength,
+        size_t offset,
+        size_t matchLength)
+{
+    if (op >= oend)
+    {
+        return false;
+    }
+
+    size_t matchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+    char *token = op++;
+    *token = (char)(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+    if (literalLength >= 15 && !writeLength(op, oend, literalLength - 15))
+    {
+        return false;
+    }
+
+    if ((size_t)(oend - op) < literalLength)
+    {
+        return false;
+    }
+
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    if (matchLength == 0)
+    {
+        return true;
+    }
+
+    if (oend - op < 2)
+    {
+        return false;
+    }
+
+    *op++ = (char)(offset & 0xff);
+    *op++ = (char)(offset >> 8);
+
+    return matchCode < 15 || writeLength(op, oend, matchCode - 15);
+}
+
+size_t LzCodec::compress(const char *src, size_t size, char *dst, size_t capacity)
+{
+    // positions of the last occurrence of every hashed 4 bytes
+    std::unique_ptr<uint32_t[]> table(new uint32_t[1 << LZ_HASH_BITS]());
+
+    const char *ip = src;
+    const char *anchor = src;
+    const char *end = src + size;
+    const char *matchLimit = size > LZ_END_LITERALS ? end - LZ_END_LITERALS : src;
+    char *op = dst;
+    const char *oend = dst + capacity;
+
+    while (ip + LZ_MIN_MATCH <= matchLimit)
+    {
+        uint32_t sequence = read32(ip);
+        uint32_t &slot = table[hash32(sequence)];
+        const char *ref = src + slot;
+        slot = (uint32_t)(ip - src);
+
+        if (ref >= ip || (size_t)(ip - ref) > LZ_MAX_OFFSET || read32(ref) != sequence)
+        {
+            // skip faster through data that doesn't compress
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        const char *mp = ip + LZ_MIN_MATCH;
+        const char *rp = ref + LZ_MIN_MATCH;
+        while (mp < matchLimit && *mp == *rp)
+        {
+            mp++;
+            rp++;
+        }
+
+        if (!writeSequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), (size_t)(mp - ip)))
+        {
+            return 0;
+        }
+
+        ip = mp;
+        anchor = ip;
+    }
+
+    if (!writeSequence(op, oend, anchor, (size_t)(end - anchor), 0, 0))
+    {
+        return 0;
+    }
+
+    return (size_t)(op - dst);
+}
+
+static size_t readLength(const char *&ip, const char *iend)
+{
+    size_t length = 0;
+    uint8_t byte;
+    do
+    {
+        if (ip >= iend)
+        {
+            SWSS_LOG_THROW("compressed data was truncated in a length");
+        }
+
+        byte = (uint8_t)*ip++;
+        length += byte;
+    }
+    while (byte == 255);
+
+    return length;
+}
+
+void LzCodec::decompress(const char *src, size_t srcSize, char *dst, size_t size)
+{
+    const char *ip = src;
+    const char *iend = src + srcSize;
+    char *op = dst;
+    const char *oend = dst + size;
+
+    while (true)
+    {
+        if (ip >= iend)
+        {
+            SWSS_LOG_THROW("compressed data was truncated, size: %zu", srcSize);
+        }
+
+        uint8_t token = (uint8_t)*ip++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            literalLength += readLength(ip, iend);
+        }
+
+        if (literalLength > (size_t)(iend - ip) || literalLength > (size_t)(oend - op))
+        {
+            SWSS_LOG_THROW("compressed literals overflow, length: %zu", literalLength);
+        }
+
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        // the last sequence has no match
+        if (ip == iend)
+        {
+            break;
+        }
+
+        if (iend - ip < 2)
+        {
+            SWSS_LOG_THROW("compressed data was truncated in an offset");
+        }
+
+        size_t offset = (uint8_t)ip[0] | ((size_t)(uint8_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst))
+        {
+            SWSS_LOG_THROW("compressed match offset %zu is out of range", offset);
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            matchLength += readLength(ip, iend);
+        }
+
+        matchLength += LZ_MIN_MATCH;
+        if (matchLength > (size_t)(oend - op))
+        {
+            SWSS_LOG_THROW("compressed match overflows the output, length: %zu", matchLength);
+        }
+
+        const char *match = op - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        }
+        else
+        {
+            // the match overlaps the bytes it writes, copy forward
+            for (size_t i = 0; i < matchLength; i++)
+            {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    if (op != oend)
+    {
+        SWSS_LOG_THROW("compressed data decompressed to %zu bytes, expected %zu", (size_t)(op - dst), size);
+    }
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace swss {
+
+/*
+ * Small LZ77 block codec for messages with repeated text, like the field
+ * names and values of a batch of routes. The block is a series of
+ * sequences in the LZ4 style: a token with the literal length and the
+ * match length, the literals, then a 2 byte offset into the last 64 KB
+ * of output and the rest of the match length. The last sequence has
+ * literals only. It trades ratio for speed, there is no entropy coding.
+ */
+class LzCodec
+{
+public:
+    /* Size of the output of compress() in the worst case */
+    static size_t compressBound(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    /* Returns the compressed size, or 0 when it doesn't fit in capacity */
+    static size_t compress(const char *src, size_t size, char *dst, size_t capacity);
+
+    /* Throws when src is corrupt or doesn't decompress to exactly size bytes */
+    static void decompress(const char *src, size_t srcSize, char *dst, size_t size);
+};
+
+}
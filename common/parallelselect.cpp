@@ -0,0 +1,326 @@
+#include <string.h>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include "common/logger.h"
+#include "common/parallelselect.h"
+
+using namespace std;
+
+namespace swss {
+
+/* Backoff of the dispatcher after a failed select */
+static const chrono::milliseconds ERROR_BACKOFF_MIN(10);
+static const chrono::milliseconds ERROR_BACKOFF_MAX(1000);
+
+/* Selectable whose handler runs on this thread, and its ParallelSelect */
+static thread_local const ParallelSelect *t_handlerOwner = nullptr;
+static thread_local Selectable *t_handlerSelectable = nullptr;
+
+ParallelSelect::ParallelSelect(size_t workerCount) :
+    m_controlEvent(numeric_limits<int>::max()),
+    m_nextWorker(0),
+    m_stopping(false),
+    m_queuedTasks(0)
+{
+    m_select.addSelectable(&m_controlEvent);
+
+    workerCount = max<size_t>(workerCount, 1);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back(new Worker());
+    }
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_workers[i]->thread = thread(&ParallelSelect::workerThread, this, i);
+    }
+
+    m_dispatchThread = thread(&ParallelSelect::dispatchThread, this);
+}
+
+ParallelSelect::~ParallelSelect()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_controlEvent.notify();
+    m_dispatchThread.join();
+
+    // workers drain the queued tasks before they exit
+    m_workCv.notify_all();
+    for (auto &worker : m_workers)
+    {
+        worker->thread.join();
+    }
+}
+
+void ParallelSelect::addSelectable(Selectable *selectable, Handler handler, bool edgeTriggered)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        unique_ptr<Entry> entry(new Entry());
+        entry->selectable = selectable;
+        entry->handler = handler;
+        entry->edgeTriggered = edgeTriggered;
+        entry->inFlight = false;
+        entry->removed = false;
+        entry->worker = m_nextWorker++ % m_workers.size();
+
+        m_pendingAdds.push_back(move(entry));
+    }
+
+    m_controlEvent.notify();
+}
+
+void ParallelSelect::removeSelectable(Selectable *selectable)
+{
+    unique_lock<mutex> lock(m_mutex);
+
+    // not seen by the dispatcher yet
+    auto pending = find_if(m_pendingAdds.begin(), m_pendingAdds.end(),
+            [selectable](const unique_ptr<Entry> &entry) { return entry->selectable == selectable; });
+    if (pending != m_pendingAdds.end())
+    {
+        m_pendingAdds.erase(pending);
+        return;
+    }
+
+    if (m_entries.find(selectable) == m_entries.end())
+    {
+        SWSS_LOG_WARN("Selectable is not in the list, ignoring.");
+        return;
+    }
+
+    m_pendingRemoves.push_back(selectable);
+    m_controlEvent.notify();
+
+    // the own handler is what we would wait for, the entry is erased when it returns
+    if (t_handlerOwner == this && t_handlerSelectable == selectable)
+    {
+        return;
+    }
+
+    m_removedCv.wait(lock, [this, selectable]() {
+            return m_entries.find(selectable) == m_entries.end();
+        });
+}
+
+void ParallelSelect::dispatchThread()
+{
+    SWSS_LOG_ENTER();
+
+    chrono::milliseconds backoff(0);
+    while (true)
+    {
+        Selectable *sel;
+        int ret = m_select.select(&sel);
+        if (ret != Select::OBJECT)
+        {
+            // a persistent error would spin, back off until select recovers
+            backoff = min(max(backoff * 2, ERROR_BACKOFF_MIN), ERROR_BACKOFF_MAX);
+            SWSS_LOG_ERROR("select failed: %s, retry in %lld ms", Select::resultToString(ret).c_str(), (long long)backoff.count());
+
+            this_thread::sleep_for(backoff);
+
+            lock_guard<mutex> lock(m_mutex);
+            if (m_stopping)
+            {
+                break;
+            }
+            continue;
+        }
+
+        backoff = chrono::milliseconds(0);
+
+        try
+        {
+            if (sel == &m_controlEvent)
+            {
+                if (!processControl())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // m_entries is only modified by this thread
+            auto it = m_entries.find(sel);
+            if (it != m_entries.end())
+            {
+                dispatch(it->second.get());
+            }
+        }
+        catch (const exception &e)
+        {
+            SWSS_LOG_ERROR("dispatch failed: %s", e.what());
+        }
+    }
+}
+
+bool ParallelSelect::processControl()
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    if (m_stopping)
+    {
+        return false;
+    }
+
+    bool removed = false;
+
+    for (auto &entry : m_pendingAdds)
+    {
+        Selectable *sel = entry->selectable;
+        bool edgeTriggered = entry->edgeTriggered;
+        m_entries[sel] = move(entry);
+        m_select.addSuspendable(sel, edgeTriggered);
+    }
+    m_pendingAdds.clear();
+
+    for (auto sel : m_pendingRemoves)
+    {
+        auto it = m_entries.find(sel);
+        if (it == m_entries.end())
+        {
+            continue;
+        }
+
+        // suspended while in flight, so it isn't read after the removal
+        m_select.removeSelectable(sel);
+
+        if (it->second->inFlight)
+        {
+            // erased when the handler returns
+            it->second->removed = true;
+            continue;
+        }
+
+        m_entries.erase(it);
+        removed = true;
+    }
+    m_pendingRemoves.clear();
+
+    for (auto entry : m_completed)
+    {
+        Selectable *sel = entry->selectable;
+
+        entry->inFlight = false;
+        if (entry->removed)
+        {
+            m_entries.erase(sel);
+            removed = true;
+            continue;
+        }
+
+        m_select.resume(sel);
+    }
+    m_completed.clear();
+
+    if (removed)
+    {
+        m_removedCv.notify_all();
+    }
+
+    return true;
+}
+
+void ParallelSelect::dispatch(Entry *entry)
+{
+    // select() suspended the selectable, it isn't read while its handler is in flight
+    entry->inFlight = true;
+
+    auto &worker = *m_workers[entry->worker];
+    {
+        lock_guard<mutex> lock(m_mutex);
+        {
+            lock_guard<mutex> workerLock(worker.mutex);
+            worker.tasks.push_back(entry);
+        }
+        m_queuedTasks++;
+    }
+
+    m_workCv.notify_one();
+}
+
+ParallelSelect::Entry *ParallelSelect::popTask(size_t index)
+{
+    {
+        auto &own = *m_workers[index];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            Entry *entry = own.tasks.front();
+            own.tasks.pop_front();
+            return entry;
+        }
+    }
+
+    for (size_t i = 1; i < m_workers.size(); i++)
+    {
+        auto &victim = *m_workers[(index + i) % m_workers.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            Entry *entry = victim.tasks.back();
+            victim.tasks.pop_back();
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+void ParallelSelect::workerThread(size_t index)
+{
+    SWSS_LOG_ENTER();
+
+    while (true)
+    {
+        Entry *entry = popTask(index);
+        if (entry == NULL)
+        {
+            unique_lock<mutex> lock(m_mutex);
+            if (m_stopping && m_queuedTasks == 0)
+            {
+                return;
+            }
+
+            m_workCv.wait(lock, [this]() { return m_queuedTasks > 0 || m_stopping; });
+            continue;
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_queuedTasks--;
+        }
+
+        t_handlerOwner = this;
+        t_handlerSelectable = entry->selectable;
+        try
+        {
+            entry->handler(entry->selectable);
+        }
+        catch (const exception &e)
+        {
+            SWSS_LOG_ERROR("handler failed: %s", e.what());
+        }
+        t_handlerOwner = nullptr;
+        t_handlerSelectable = nullptr;
+
+        // keep the selectable on the worker that ran it
+        entry->worker = index;
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_completed.push_back(entry);
+        }
+
+        m_controlEvent.notify();
+    }
+}
+
+}
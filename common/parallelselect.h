@@ -0,0 +1,127 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <unordered_map>
+#include "select.h"
+#include "selectableevent.h"
+
+namespace swss {
+
+/*
+ * Select that runs the handlers of ready selectables on a pool of worker
+ * threads.
+ *
+ * A dispatcher thread waits on an internal Select. A ready selectable is
+ * suspended in the Select and queued to a worker together with its handler,
+ * so at most one handler per selectable is in flight and the selectable is
+ * never read while its handler runs. The fd stays registered with
+ * EPOLLONESHOT, once the handler returns one epoll_ctl() re-arms it and the
+ * selectable is dispatched again if it still has cached data.
+ *
+ * Every worker owns a deque. A selectable goes to the worker that ran it the
+ * last time, an idle worker steals from the back of the other deques. One
+ * slow handler then only delays its own selectable, independent tables are
+ * processed concurrently.
+ *
+ * Handlers run on the worker threads and must consume the data of their
+ * selectable, e.g. by calling pops(). Handlers of different selectables may
+ * run at the same time.
+ *
+ * When the internal select fails the dispatcher logs the error and retries
+ * with a backoff of up to a second.
+ */
+class ParallelSelect
+{
+public:
+    typedef std::function<void(Selectable *)> Handler;
+
+    ParallelSelect(size_t workerCount = std::thread::hardware_concurrency());
+    ~ParallelSelect();
+
+    /* Add object for select, the handler runs on a worker when it is ready */
+    void addSelectable(Selectable *selectable, Handler handler, bool edgeTriggered = false);
+
+    /*
+     * Remove object from select, waits for an in-flight handler to return.
+     * Called from the handler of the selectable itself it returns at once,
+     * the selectable is removed when the handler returns and isn't
+     * dispatched again. Handlers must not remove each other, each would
+     * wait for the other one.
+     */
+    void removeSelectable(Selectable *selectable);
+
+    size_t getWorkerCount() const
+    {
+        return m_workers.size();
+    }
+
+private:
+    struct Entry
+    {
+        Selectable *selectable;
+        Handler handler;
+        bool edgeTriggered;
+        bool inFlight;
+        bool removed;
+        size_t worker; // worker that ran the handler the last time
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Entry *> tasks;
+        std::thread thread;
+    };
+
+    void dispatchThread();
+
+    void workerThread(size_t index);
+
+    /* Apply queued requests and completed handlers, false on shutdown */
+    bool processControl();
+
+    void dispatch(Entry *entry);
+
+    /* Pop from the own deque front, steal from the back of the others */
+    Entry *popTask(size_t index);
+
+    Select m_select;
+
+    /* Wakes up the dispatcher for requests and completed handlers */
+    SelectableEvent m_controlEvent;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::thread m_dispatchThread;
+
+    size_t m_nextWorker;
+
+    /* Protects everything below */
+    std::mutex m_mutex;
+
+    /* Signaled when an entry is removed */
+    std::condition_variable m_removedCv;
+
+    /* Signaled when a task is queued or on shutdown */
+    std::condition_variable m_workCv;
+
+    bool m_stopping;
+
+    size_t m_queuedTasks;
+
+    std::unordered_map<Selectable *, std::unique_ptr<Entry>> m_entries;
+
+    std::vector<std::unique_ptr<Entry>> m_pendingAdds;
+
+    std::vector<Selectable *> m_pendingRemoves;
+
+    std::vector<Entry *> m_completed;
+};
+
+}
@@ -1,4 +1,5 @@
 #include <string>
+#include <algorithm>
 #include <memory>
 #include <hiredis/hiredis.h>
 #include "dbconnector.h"
@@ -110,4 +111,9 @@ void RedisSelect::setQueueLength(long long int queueLength)
     m_queueLength = queueLength;
 }
 
+void RedisSelect::collapseQueueLength(long long int pendingReads)
+{
+    m_queueLength = std::min(m_queueLength, pendingReads);
+}
+
 }
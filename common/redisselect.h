@@ -33,6 +33,12 @@ public:
 
     void setQueueLength(long long int queueLength);
 
+    /*
+     * Drop queued notifications once a read found that at most pendingReads
+     * more reads will return data, e.g. after a pop drained the key set.
+     */
+    void collapseQueueLength(long long int pendingReads);
+
 protected:
     std::unique_ptr<DBConnector> m_subscribe;
     long long int m_queueLength;
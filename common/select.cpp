@@ -1,7 +1,12 @@
 #include "common/selectable.h"
 #include "common/logger.h"
 #include "common/select.h"
+#include "common/table.h"
 #include <algorithm>
+#include <chrono>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -14,7 +19,13 @@ using namespace std;
 
 namespace swss {
 
-Select::Select()
+Select::Select() :
+    m_readyCount(0),
+    m_busyPollMax(0),
+    m_busyPollWindow(0),
+    m_profiling(false),
+    m_profileDumpInterval(0),
+    m_profileTable(NULL)
 {
     m_epoll_fd = ::epoll_create1(0);
     if (m_epoll_fd == -1)
@@ -31,7 +42,17 @@ Select::~Select()
     (void)::close(m_epoll_fd);
 }
 
-void Select::addSelectable(Selectable *selectable)
+void Select::addSelectable(Selectable *selectable, bool edgeTriggered)
+{
+    addEntry(selectable, edgeTriggered, false);
+}
+
+void Select::addSuspendable(Selectable *selectable, bool edgeTriggered)
+{
+    addEntry(selectable, edgeTriggered, true);
+}
+
+void Select::addEntry(Selectable *selectable, bool edgeTriggered, bool oneShot)
 {
     const int fd = selectable->getFd();
 
@@ -41,16 +62,44 @@ void Select::addSelectable(Selectable *selectable)
         return;
     }
 
-    m_objects[fd] = selectable;
+    int priority = selectable->getPri();
+    auto &bucket = m_buckets[priority];
+    bucket.refCount++;
+
+    Entry *entry = new Entry();
+    entry->selectable = selectable;
+    entry->priority = priority;
+    entry->bucket = &bucket;
+    entry->events = EPOLLIN;
+    entry->ready = false;
+    entry->oneShot = oneShot;
+    entry->armed = true;
+    entry->suspended = false;
+    m_objects[fd].reset(entry);
+
+    if (edgeTriggered)
+    {
+        entry->events |= EPOLLET;
+    }
+
+    if (oneShot)
+    {
+        entry->events |= EPOLLONESHOT;
+    }
+
+    if (m_events.size() < m_objects.size())
+    {
+        m_events.resize(m_objects.size());
+    }
 
     if (selectable->initializedWithData())
     {
-        m_ready.insert(selectable);
+        pushReady(entry);
     }
 
     struct epoll_event ev = {
-        .events = EPOLLIN,
-        .data = { .fd = fd, },
+        .events = entry->events,
+        .data = { .ptr = entry, },
     };
 
     int res = ::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev);
@@ -63,12 +112,78 @@ void Select::addSelectable(Selectable *selectable)
     }
 }
 
+void Select::arm(Entry *entry, uint32_t events)
+{
+    struct epoll_event ev = {
+        .events = events,
+        .data = { .ptr = entry, },
+    };
+
+    int res = ::epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, entry->selectable->getFd(), &ev);
+    if (res == -1)
+    {
+        std::string error = std::string("Select::mod_fd:epoll_ctl: error=("
+                          + std::to_string(errno) + "}:"
+                          + strerror(errno));
+        throw std::runtime_error(error);
+    }
+
+    entry->armed = (events & EPOLLIN) != 0;
+}
+
+void Select::suspend(Entry *entry)
+{
+    entry->suspended = true;
+
+    // returned from the cache rather than by the kernel, the fd is still armed
+    if (entry->armed)
+    {
+        arm(entry, EPOLLONESHOT);
+    }
+}
+
+void Select::resume(Selectable *selectable)
+{
+    auto it = m_objects.find(selectable->getFd());
+    if (it == m_objects.end() || !it->second->suspended)
+    {
+        return;
+    }
+
+    Entry *entry = it->second.get();
+    entry->suspended = false;
+    arm(entry, entry->events);
+
+    if (selectable->hasCachedData())
+    {
+        pushReady(entry);
+    }
+}
+
 void Select::removeSelectable(Selectable *selectable)
 {
     const int fd = selectable->getFd();
 
-    m_objects.erase(fd);
-    m_ready.erase(selectable);
+    auto it = m_objects.find(fd);
+    if (it != m_objects.end())
+    {
+        Entry *entry = it->second.get();
+        auto &queue = entry->bucket->queue;
+        if (entry->ready)
+        {
+            queue.erase(std::find(queue.begin(), queue.end(), entry));
+            m_readyCount--;
+        }
+
+        if (--entry->bucket->refCount == 0)
+        {
+            m_buckets.erase(entry->priority);
+        }
+
+        m_dispatched.erase(std::remove(m_dispatched.begin(), m_dispatched.end(), entry), m_dispatched.end());
+
+        m_objects.erase(it);
+    }
 
     int res = ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
     if (res == -1)
@@ -88,15 +203,13 @@ void Select::addSelectables(vector<Selectable *> selectables)
     }
 }
 
-int Select::poll_descriptors(Selectable **c, unsigned int timeout, bool interrupt_on_signal = false)
+int Select::wait_descriptors(unsigned int timeout, bool interrupt_on_signal)
 {
-    int sz_selectables = static_cast<int>(m_objects.size());
-    std::vector<struct epoll_event> events(sz_selectables);
     int ret;
 
     while(true)
     {
-        ret = ::epoll_wait(m_epoll_fd, events.data(), sz_selectables, timeout);
+        ret = ::epoll_wait(m_epoll_fd, m_events.data(), static_cast<int>(m_events.size()), timeout);
         // on signal interrupt check if we need to return
         if (ret == -1 && errno == EINTR)
         {
@@ -119,75 +232,474 @@ int Select::poll_descriptors(Selectable **c, unsigned int timeout, bool interrup
 
     for (int i = 0; i < ret; ++i)
     {
-        int fd = events[i].data.fd;
-        Selectable* sel = m_objects[fd];
+        Entry *entry = static_cast<Entry *>(m_events[i].data.ptr);
+        if (entry->oneShot)
+        {
+            entry->armed = false;
+        }
+
         try
         {
-            sel->readData();
+            entry->selectable->readData();
         }
         catch (const std::runtime_error& ex)
         {
             SWSS_LOG_ERROR("readData error: %s", ex.what());
             return Select::ERROR;
         }
-        m_ready.insert(sel);
+        pushReady(entry);
     }
 
-    while (!m_ready.empty())
+    return Select::OBJECT;
+}
+
+void Select::pushReady(Entry *entry)
+{
+    if (entry->ready || entry->suspended)
     {
-        auto sel = *m_ready.begin();
+        return;
+    }
+
+    entry->ready = true;
+    entry->bucket->queue.push_back(entry);
+    m_readyCount++;
 
-        m_ready.erase(sel);
-        // we must update clock only when the selector out of the m_ready
-        // otherwise we break invariant of the m_ready
-        sel->updateLastUsedTime();
+    if (m_profiling)
+    {
+        entry->readyTime = std::chrono::steady_clock::now();
+    }
+}
 
-        if (!sel->hasData())
+void Select::pushReady(Selectable *selectable)
+{
+    auto it = m_objects.find(selectable->getFd());
+    if (it != m_objects.end())
+    {
+        pushReady(it->second.get());
+    }
+}
+
+Select::Entry *Select::pop_ready()
+{
+    for (auto &it : m_buckets)
+    {
+        auto &queue = it.second.queue;
+        while (!queue.empty())
         {
-            continue;
-        }
+            Entry *entry = queue.front();
 
-        *c = sel;
+            queue.pop_front();
+            entry->ready = false;
+            m_readyCount--;
 
-        if (sel->hasCachedData())
+            if (entry->selectable->hasData())
+            {
+                if (entry->oneShot)
+                {
+                    suspend(entry);
+                }
+                return entry;
+            }
+
+            // a one shot fd that woke up without data has to be polled again
+            if (entry->oneShot && !entry->armed)
+            {
+                arm(entry, entry->events);
+            }
+        }
+
+        if (m_readyCount == 0)
         {
-            // reinsert Selectable back to the m_ready set, when there're more messages in the cache
-            m_ready.insert(sel);
+            break;
         }
+    }
 
-        sel->updateAfterRead();
+    return NULL;
+}
 
-        return Select::OBJECT;
+int Select::poll_descriptors(Selectable **c, unsigned int timeout, bool interrupt_on_signal = false)
+{
+    int ret = wait_descriptors(timeout, interrupt_on_signal);
+    if (ret != Select::OBJECT)
+    {
+        return ret;
     }
 
-    return Select::TIMEOUT;
+    auto entry = pop_ready();
+    if (entry == NULL)
+    {
+        return Select::TIMEOUT;
+    }
+
+    auto sel = entry->selectable;
+    *c = sel;
+
+    if (m_profiling)
+    {
+        profileDispatch(entry);
+    }
+
+    if (sel->hasCachedData())
+    {
+        // requeue Selectable behind its equal priority peers, when there're more messages in the cache
+        pushReady(entry);
+    }
+
+    sel->updateAfterRead();
+
+    return Select::OBJECT;
 }
 
-int Select::select(Selectable **c, int timeout, bool interrupt_on_signal)
+void Select::growBusyPollWindow()
 {
-    SWSS_LOG_ENTER();
+    m_busyPollWindow = std::min(m_busyPollMax, std::max(m_busyPollWindow * 2, std::chrono::microseconds(1)));
+}
 
-    int ret;
+template <typename Poll>
+int Select::busy_poll(Poll poll, std::chrono::steady_clock::time_point deadline, bool bounded)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + m_busyPollWindow;
+    if (bounded)
+    {
+        end = std::min(end, deadline);
+    }
 
-    *c = NULL;
+    for (auto now = start; now < end; now = std::chrono::steady_clock::now())
+    {
+        int ret = poll(0, false);
+        if (ret != Select::TIMEOUT)
+        {
+            growBusyPollWindow();
+            return ret;
+        }
+    }
+
+    m_busyPollWindow /= 2;
+
+    return Select::TIMEOUT;
+}
 
+template <typename Poll>
+int Select::poll_until_timeout(Poll poll, int timeout, bool interrupt_on_signal)
+{
     /* check if we have some data */
-    ret = poll_descriptors(c, 0);
+    int ret = poll(0, false);
 
     /* return if we have data, we have an error or desired timeout was 0 */
     if (ret != Select::TIMEOUT || timeout == 0)
         return ret;
 
-    /* wait for data */
-    ret = poll_descriptors(c, timeout, interrupt_on_signal);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    if (m_busyPollWindow.count() > 0)
+    {
+        ret = busy_poll(poll, deadline, timeout > 0);
+        if (ret != Select::TIMEOUT)
+        {
+            return ret;
+        }
+
+        if (timeout > 0)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                return ret;
+            }
+
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+            timeout = static_cast<int>((remaining + 999) / 1000);
+        }
+    }
+
+    /* wait for data. A wakeup that yields no data, for example a
+     * KeyspaceDispatcher that only routed events to other selectables,
+     * doesn't end the wait before the timeout expires */
+    auto blocked = std::chrono::steady_clock::now();
+    while (true)
+    {
+        ret = poll(timeout, interrupt_on_signal);
+        if (ret != Select::TIMEOUT)
+        {
+            // the event came just after we gave up spinning
+            if (m_busyPollMax.count() > 0 && std::chrono::steady_clock::now() - blocked < m_busyPollMax)
+            {
+                growBusyPollWindow();
+            }
+            return ret;
+        }
+
+        if (timeout < 0)
+        {
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return ret;
+        }
+
+        // round up, so that we never spin on a zero timeout
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+        timeout = static_cast<int>((remaining + 999) / 1000);
+    }
+}
+
+int Select::select(Selectable **c, int timeout, bool interrupt_on_signal)
+{
+    SWSS_LOG_ENTER();
+
+    *c = NULL;
+
+    profileHandlers();
+
+    return poll_until_timeout([this, c](int t, bool interrupt) -> int {
+            return poll_descriptors(c, t, interrupt);
+        }, timeout, interrupt_on_signal);
+}
+
+int Select::selectMany(vector<Selectable *> &selectables, int timeout, bool interrupt_on_signal)
+{
+    SWSS_LOG_ENTER();
+
+    selectables.clear();
+
+    profileHandlers();
+
+    return poll_until_timeout([this, &selectables](int t, bool interrupt) -> int {
+            int ret = wait_descriptors(t, interrupt);
+            if (ret != Select::OBJECT)
+            {
+                return ret;
+            }
+
+            m_drained.clear();
+            Entry *entry;
+            while ((entry = pop_ready()) != NULL)
+            {
+                m_drained.push_back(entry);
+                selectables.push_back(entry->selectable);
+
+                if (m_profiling)
+                {
+                    profileDispatch(entry);
+                }
+            }
+
+            // requeue after the drain, so that every selectable is returned
+            // once per call and the next call sees the remaining cached data
+            for (auto e : m_drained)
+            {
+                if (e->selectable->hasCachedData())
+                {
+                    pushReady(e);
+                }
+
+                e->selectable->updateAfterRead();
+            }
+
+            return selectables.empty() ? Select::TIMEOUT : Select::OBJECT;
+        }, timeout, interrupt_on_signal);
+}
+
+void Select::setBusyPollWindow(unsigned int usec)
+{
+    m_busyPollMax = std::chrono::microseconds(usec);
+    m_busyPollWindow = m_busyPollMax;
+}
+
+void Select::LatencyHistogram::add(uint64_t us)
+{
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && (us >> bucket) != 0)
+    {
+        bucket++;
+    }
+
+    counts[bucket]++;
+    samples++;
+    totalUs += us;
+    maxUs = std::max(maxUs, us);
+}
+
+std::string Select::LatencyHistogram::toString() const
+{
+    std::string str;
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+
+        if (!str.empty())
+        {
+            str += ",";
+        }
+
+        str += std::to_string(1ULL << i) + ":" + std::to_string(counts[i]);
+    }
+
+    return str;
+}
+
+static std::string profileName(Selectable *selectable)
+{
+    int status;
+    const char *mangled = typeid(*selectable).name();
+    std::unique_ptr<char, void (*)(void *)> demangled(abi::__cxa_demangle(mangled, NULL, NULL, &status), free);
+
+    std::string name = (status == 0) ? demangled.get() : mangled;
+
+    auto table = dynamic_cast<TableBase *>(selectable);
+    if (table != NULL)
+    {
+        return name + ":" + table->getTableName();
+    }
+
+    return name + ":" + std::to_string(selectable->getFd());
+}
+
+void Select::enableProfiling(bool enable)
+{
+    m_profiling = enable;
+    m_dispatched.clear();
+
+    // entries queued before don't have a valid ready time
+    auto now = std::chrono::steady_clock::now();
+    for (auto &it : m_objects)
+    {
+        it.second->readyTime = now;
+    }
+}
+
+void Select::resetProfile()
+{
+    for (auto &it : m_objects)
+    {
+        it.second->profile.reset();
+    }
+}
+
+std::vector<Select::SelectableProfile> Select::getProfile() const
+{
+    std::vector<SelectableProfile> profiles;
+    for (auto &it : m_objects)
+    {
+        if (it.second->profile)
+        {
+            profiles.push_back(*it.second->profile);
+        }
+    }
+
+    return profiles;
+}
+
+std::vector<Select::SelectableProfile> Select::getTopHandlers(size_t count) const
+{
+    auto profiles = getProfile();
+
+    std::sort(profiles.begin(), profiles.end(), [](const SelectableProfile &a, const SelectableProfile &b) {
+            return a.handlerTime.totalUs > b.handlerTime.totalUs;
+        });
+
+    if (profiles.size() > count)
+    {
+        profiles.resize(count);
+    }
+
+    return profiles;
+}
+
+void Select::dumpProfile(Table *table) const
+{
+    for (auto &profile : getProfile())
+    {
+        auto &queued = profile.queuedTime;
+        auto &handler = profile.handlerTime;
+        uint64_t dispatches = std::max<uint64_t>(profile.dispatchCount, 1);
+
+        if (table == NULL)
+        {
+            SWSS_LOG_NOTICE("%s: dispatches %" PRIu64 " queued avg %" PRIu64 "us max %" PRIu64 "us handler avg %" PRIu64 "us max %" PRIu64 "us",
+                    profile.name.c_str(), profile.dispatchCount,
+                    queued.totalUs / dispatches, queued.maxUs,
+                    handler.totalUs / std::max<uint64_t>(handler.samples, 1), handler.maxUs);
+            continue;
+        }
+
+        std::vector<FieldValueTuple> fvs = {
+            { "dispatch_count", std::to_string(profile.dispatchCount) },
+            { "queued_time_avg_us", std::to_string(queued.totalUs / dispatches) },
+            { "queued_time_max_us", std::to_string(queued.maxUs) },
+            { "queued_time_histogram", queued.toString() },
+            { "handler_time_avg_us", std::to_string(handler.totalUs / std::max<uint64_t>(handler.samples, 1)) },
+            { "handler_time_max_us", std::to_string(handler.maxUs) },
+            { "handler_time_histogram", handler.toString() },
+        };
+
+        table->set(profile.name, fvs);
+    }
+}
+
+void Select::setProfileDump(unsigned int intervalSec, Table *table)
+{
+    m_profileDumpInterval = std::chrono::seconds(intervalSec);
+    m_profileTable = table;
+    m_nextProfileDump = std::chrono::steady_clock::now() + m_profileDumpInterval;
+}
+
+void Select::profileHandlers()
+{
+    if (!m_profiling)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    if (!m_dispatched.empty())
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_dispatchTime).count();
+        uint64_t share = static_cast<uint64_t>(elapsed) / m_dispatched.size();
+        for (auto entry : m_dispatched)
+        {
+            entry->profile->handlerTime.add(share);
+        }
+        m_dispatched.clear();
+    }
+
+    if (m_profileDumpInterval.count() > 0 && now >= m_nextProfileDump)
+    {
+        dumpProfile(m_profileTable);
+        m_nextProfileDump = now + m_profileDumpInterval;
+    }
+}
+
+void Select::profileDispatch(Entry *entry)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    if (!entry->profile)
+    {
+        entry->profile.reset(new SelectableProfile());
+        entry->profile->selectable = entry->selectable;
+        entry->profile->name = profileName(entry->selectable);
+    }
 
-    return ret;
+    entry->profile->dispatchCount++;
+    entry->profile->queuedTime.add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - entry->readyTime).count()));
 
+    m_dispatched.push_back(entry);
+    m_dispatchTime = now;
 }
 
 bool Select::isQueueEmpty()
 {
-    return m_ready.empty();
+    return m_readyCount == 0;
 }
 
 std::string Select::resultToString(int result)
@@ -3,22 +3,61 @@
 
 #include <string>
 #include <vector>
-#include <queue>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
 #include <unordered_map>
-#include <set>
+#include <sys/epoll.h>
 #include <hiredis/hiredis.h>
 #include "selectable.h"
 
 namespace swss {
 
+class Table;
+
 class Select
 {
 public:
+    /* Latency histogram with power of two microsecond buckets */
+    struct LatencyHistogram
+    {
+        static constexpr size_t BUCKETS = 32;
+
+        /* Bucket 0 counts samples below 1us, bucket i samples in [2^(i-1), 2^i) us */
+        uint64_t counts[BUCKETS] = {};
+        uint64_t samples = 0;
+        uint64_t totalUs = 0;
+        uint64_t maxUs = 0;
+
+        void add(uint64_t us);
+
+        /* Non empty buckets as "upper bound in us:count", comma separated */
+        std::string toString() const;
+    };
+
+    struct SelectableProfile
+    {
+        Selectable *selectable = nullptr;
+        std::string name;
+        uint64_t dispatchCount = 0;
+
+        /* From readiness, or requeue with cached data, to dispatch */
+        LatencyHistogram queuedTime;
+
+        /* From dispatch to the next select() call */
+        LatencyHistogram handlerTime;
+    };
+
     Select();
     ~Select();
 
-    /* Add object for select */
-    void addSelectable(Selectable *selectable);
+    /*
+     * Add object for select. An edge triggered selectable is only reported
+     * when new data arrives, so its readData() has to drain the fd fully.
+     */
+    void addSelectable(Selectable *selectable, bool edgeTriggered = false);
 
     /* Remove object from select */
     void removeSelectable(Selectable *selectable);
@@ -33,9 +72,55 @@ public:
         SIGNALINT = 3,// Read operation interrupted by a signal
     };
 
+    /*
+     * Wait up to timeout ms for a selectable with data. A wakeup that
+     * yields no selectable, e.g. a KeyspaceDispatcher that only routed
+     * events, or a selectable whose readData() found nothing, doesn't
+     * return TIMEOUT early, the wait goes on until the timeout expires.
+     */
     int select(Selectable **c, int timeout = -1, bool interrupt_on_signal = false);
+
+    /*
+     * Return all the ready selectables in one call, ordered by priority the
+     * same way consecutive select() calls would return them. Each selectable
+     * is returned at most once, one with more cached data is returned again
+     * by the next call. The vector is empty unless the result is OBJECT.
+     * Wakeups without data don't end the wait early, like in select().
+     */
+    int selectMany(std::vector<Selectable *> &selectables, int timeout = -1, bool interrupt_on_signal = false);
+
     bool isQueueEmpty();
 
+    /*
+     * Spin on the descriptors for up to the given window before select()
+     * blocks, which saves the sleep and wakeup latency when events arrive
+     * back to back. The window halves after every spin that found nothing
+     * and doubles again when events arrive within the configured window,
+     * so an idle Select falls back to plain blocking. 0 disables spinning.
+     */
+    void setBusyPollWindow(unsigned int usec);
+
+    /*
+     * Record per selectable dispatch counts, queued time and handler time.
+     * The handler time is the time until the application calls select()
+     * again, a selectMany() batch splits it evenly. A selectable drops its
+     * profile when it is removed.
+     */
+    void enableProfiling(bool enable);
+
+    void resetProfile();
+
+    std::vector<SelectableProfile> getProfile() const;
+
+    /* Profiles with the largest total handler time first */
+    std::vector<SelectableProfile> getTopHandlers(size_t count) const;
+
+    /* Write one entry per selectable to the table, or to the log when table is NULL */
+    void dumpProfile(Table *table = NULL) const;
+
+    /* Dump the profile from select() every interval seconds, 0 disables */
+    void setProfileDump(unsigned int intervalSec, Table *table = NULL);
+
     /**
      * @brief Result to string.
      *
@@ -44,33 +129,96 @@ public:
     static std::string resultToString(int result);
 
 private:
-    struct cmp
+    friend class ParallelSelect;
+    friend class CoroutineScheduler;
+
+    struct ReadyBucket;
+
+    /* Per selectable state, registered as the epoll data pointer */
+    struct Entry
+    {
+        Selectable *selectable;
+        int priority; // key of the bucket, getPri() may change after the add
+        ReadyBucket *bucket;
+        uint32_t events;
+        bool ready;
+        bool oneShot;
+        bool armed; // a one shot fd is disarmed by the kernel once reported
+        bool suspended;
+        std::chrono::steady_clock::time_point readyTime;
+        std::unique_ptr<SelectableProfile> profile;
+    };
+
+    /*
+     * FIFO of ready selectables sharing one priority. Popping from the front
+     * and appending to the back gives round robin among equal priorities.
+     */
+    struct ReadyBucket
     {
-        bool operator()(const Selectable* a, const Selectable* b) const
-        {
-            /* Choose Selectable with highest priority first */
-            if (a->getPri() > b->getPri())
-                return true;
-            else if (a->getPri() < b->getPri())
-                return false;
-
-            /* if the priorities are equal */
-            /* use Selectable which was selected earlier */
-            if (a->getLastUsedTime() < b->getLastUsedTime())
-                return true;
-            else if (a->getLastUsedTime() > b->getLastUsedTime())
-                return false;
-
-            /* when a == b */
-            return false;
-        }
+        std::deque<Entry *> queue;
+        size_t refCount = 0;
     };
 
+    void addEntry(Selectable *selectable, bool edgeTriggered, bool oneShot);
+
+    /*
+     * Add a selectable that is suspended whenever select() returns it, until
+     * resume(). The fd is registered with EPOLLONESHOT, so a suspended
+     * selectable is neither polled nor read and stays registered.
+     */
+    void addSuspendable(Selectable *selectable, bool edgeTriggered = false);
+
+    /* Re-arm a suspended selectable, queue it when it still has cached data */
+    void resume(Selectable *selectable);
+
+    void suspend(Entry *entry);
+
+    void arm(Entry *entry, uint32_t events);
+
+    void pushReady(Entry *entry);
+
+    /* Queue an added selectable as ready, e.g. when it still has cached data */
+    void pushReady(Selectable *selectable);
+
     int poll_descriptors(Selectable **c, unsigned int timeout, bool interrupt_on_signal);
 
+    /* Wait for the descriptors and queue the signaled selectables as ready */
+    int wait_descriptors(unsigned int timeout, bool interrupt_on_signal);
+
+    /* Pop the next ready selectable with data, highest priority first */
+    Entry *pop_ready();
+
+    /* Retry the wait until the timeout expires while the wait yields no data */
+    template <typename Poll>
+    int poll_until_timeout(Poll poll, int timeout, bool interrupt_on_signal);
+
+    /* Spin on the descriptors within the busy poll window */
+    template <typename Poll>
+    int busy_poll(Poll poll, std::chrono::steady_clock::time_point deadline, bool bounded);
+
+    void growBusyPollWindow();
+
+    /* Account the handler time of the last dispatch and dump when due */
+    void profileHandlers();
+
+    void profileDispatch(Entry *entry);
+
     int m_epoll_fd;
-    std::unordered_map<int, Selectable *> m_objects;
-    std::set<Selectable *, Select::cmp> m_ready;
+    std::vector<struct epoll_event> m_events;
+    std::unordered_map<int, std::unique_ptr<Entry>> m_objects;
+    /* Buckets ordered by priority, highest first */
+    std::map<int, ReadyBucket, std::greater<int>> m_buckets;
+    size_t m_readyCount;
+    std::chrono::microseconds m_busyPollMax;
+    std::chrono::microseconds m_busyPollWindow;
+    std::vector<Entry *> m_drained;
+
+    bool m_profiling;
+    std::vector<Entry *> m_dispatched;
+    std::chrono::steady_clock::time_point m_dispatchTime;
+    std::chrono::seconds m_profileDumpInterval;
+    std::chrono::steady_clock::time_point m_nextProfileDump;
+    Table *m_profileTable;
 };
 
 }
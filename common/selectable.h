@@ -4,7 +4,6 @@
 #include <string>
 #include <vector>
 #include <limits>
-#include <chrono>
 #include <hiredis/hiredis.h>
 
 namespace swss {
@@ -12,8 +11,7 @@ namespace swss {
 class Selectable
 {
 public:
-    Selectable(int pri = 0) : m_priority(pri),
-                              m_last_used_time(std::chrono::steady_clock::now()) {}
+    Selectable(int pri = 0) : m_priority(pri) {}
 
     virtual ~Selectable() = default;
 
@@ -59,25 +57,8 @@ public:
     }
 
 private:
-
-    friend class Select;
-
-    // only Select class can access and update m_last_used_time
-
-    std::chrono::time_point<std::chrono::steady_clock> getLastUsedTime() const
-    {
-        return m_last_used_time;
-    }
-
-    void updateLastUsedTime()
-    {
-        m_last_used_time = std::chrono::steady_clock::now();
-    }
-
-
     int m_priority; // defines priority of Selectable inside Select
                     // higher value is higher priority
-    std::chrono::time_point<std::chrono::steady_clock> m_last_used_time;
 };
 
 }
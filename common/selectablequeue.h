@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <sys/eventfd.h>
+#include "logger.h"
+#include "selectable.h"
+
+namespace swss {
+
+/*
+ * Bounded multi-producer single-consumer queue that is a Selectable.
+ *
+ * Producers on any thread push() without taking a lock, the ring is the
+ * sequence numbered cell array of Dmitry Vyukov's bounded queue. The
+ * eventfd is written only by the producer that finds the queue unsignaled,
+ * so a burst of pushes costs one write and one Select wakeup. The Select
+ * thread drains the queue with pop() or pops().
+ *
+ * The capacity is rounded up to a power of two. push() returns false when
+ * the queue is full, the producer decides whether to retry or drop.
+ * T has to be default constructible and move assignable.
+ */
+template <typename T>
+class SelectableQueue : public Selectable
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    SelectableQueue(size_t capacity = DEFAULT_CAPACITY, int pri = 0)
+        : Selectable(pri)
+        , m_enqueuePos(0)
+        , m_signaled(false)
+        , m_dequeuePos(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_efd = eventfd(0, 0);
+        if (m_efd == -1)
+        {
+            SWSS_LOG_THROW("failed to create eventfd, errno: %s", strerror(errno));
+        }
+    }
+
+    ~SelectableQueue() override
+    {
+        int err;
+
+        do
+        {
+            err = close(m_efd);
+        }
+        while(err == -1 && errno == EINTR);
+    }
+
+    /* Enqueue from any thread, false when the queue is full */
+    bool push(const T &item)
+    {
+        T copy(item);
+        return push(std::move(copy));
+    }
+
+    bool push(T &&item)
+    {
+        Cell *cell;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        // one wakeup per batch, the consumer clears the flag in readData().
+        // The fence pairs with the one in readData(): either this producer
+        // sees the cleared flag, or the consumer sees the item.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_signaled.load(std::memory_order_relaxed) &&
+            !m_signaled.exchange(true, std::memory_order_relaxed))
+        {
+            notify();
+        }
+
+        return true;
+    }
+
+    /* Dequeue on the consumer thread, false when the queue is empty */
+    bool pop(T &item)
+    {
+        Cell *cell = &m_cells[m_dequeuePos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(m_dequeuePos + 1) < 0)
+        {
+            return false;
+        }
+
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos++;
+
+        return true;
+    }
+
+    /* Replace the content of items with up to maxCount queued items */
+    void pops(std::vector<T> &items, size_t maxCount = std::numeric_limits<size_t>::max())
+    {
+        items.clear();
+
+        T item;
+        while (items.size() < maxCount && pop(item))
+        {
+            items.push_back(std::move(item));
+        }
+    }
+
+    /* Consumer side check */
+    bool empty() const
+    {
+        const Cell *cell = &m_cells[m_dequeuePos & m_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(seq) - static_cast<intptr_t>(m_dequeuePos + 1) < 0;
+    }
+
+    size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    int getFd() override
+    {
+        return m_efd;
+    }
+
+    uint64_t readData() override
+    {
+        uint64_t r;
+
+        ssize_t s;
+        do
+        {
+            s = read(m_efd, &r, sizeof(uint64_t));
+        }
+        while(s == -1 && errno == EINTR);
+
+        if (s != sizeof(uint64_t))
+        {
+            SWSS_LOG_THROW("SelectableQueue read failed, s:%zd errno: %s", s, strerror(errno));
+        }
+
+        // pushes from now on signal again, the ones before are visible to pop()
+        m_signaled.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        return 0;
+    }
+
+    bool hasData() override
+    {
+        return !empty();
+    }
+
+    bool hasCachedData() override
+    {
+        return !empty();
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    void notify()
+    {
+        uint64_t value = 1;
+        ssize_t s;
+        do
+        {
+            s = write(m_efd, &value, sizeof(uint64_t));
+        }
+        while(s == -1 && errno == EINTR);
+
+        if (s != sizeof(uint64_t))
+        {
+            SWSS_LOG_ERROR("write failed, errno: %s", strerror(errno));
+        }
+    }
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+
+    // keep the producer and consumer positions on separate cache lines
+    char m_pad0[64];
+    std::atomic<size_t> m_enqueuePos;
+    std::atomic<bool> m_signaled;
+    char m_pad1[64];
+    size_t m_dequeuePos;
+    char m_pad2[64];
+
+    int m_efd;
+};
+
+}
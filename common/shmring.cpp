@@ -0,0 +1,422 @@
+#include <string.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include "common/armhelper.h"
+#include "common/logger.h"
+#include "common/shmring.h"
+
+using namespace std;
+
+namespace swss {
+
+constexpr const char *ShmRing::ENDPOINT_PREFIX;
+
+static const uint64_t SHM_RING_MAGIC = 0x53574d52494e4731ULL; // "SWMRING1"
+
+// length marker of the padding that skips the end of the ring
+static const uint64_t SHM_RING_PADDING = UINT64_MAX;
+
+static inline uint64_t recordSize(size_t length)
+{
+    return sizeof(uint64_t) + ((length + 7) & ~(uint64_t)7);
+}
+
+static void closeFd(int fd)
+{
+    if (fd < 0)
+    {
+        return;
+    }
+
+    int err;
+    do
+    {
+        err = close(fd);
+    }
+    while (err == -1 && errno == EINTR);
+}
+
+ShmRing::ShmRing(size_t capacity)
+    : m_memfd(-1)
+    , m_eventfd(-1)
+    , m_header(nullptr)
+    , m_data(nullptr)
+    , m_mappedSize(0)
+    , m_readEnd(0)
+{
+    capacity = (capacity + 7) & ~(size_t)7;
+    if (capacity < 2 * recordSize(1))
+    {
+        SWSS_LOG_THROW("ShmRing capacity %zu is too small", capacity);
+    }
+
+    m_memfd = memfd_create("swss-shm-ring", MFD_CLOEXEC);
+    if (m_memfd == -1)
+    {
+        SWSS_LOG_THROW("memfd_create failed, errno: %s", strerror(errno));
+    }
+
+    m_eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_eventfd == -1)
+    {
+        closeFd(m_memfd);
+        SWSS_LOG_THROW("failed to create eventfd, errno: %s", strerror(errno));
+    }
+
+    size_t size = sizeof(Header) + capacity;
+    if (ftruncate(m_memfd, (off_t)size) == -1)
+    {
+        closeFd(m_memfd);
+        closeFd(m_eventfd);
+        SWSS_LOG_THROW("ftruncate of shm ring failed, errno: %s", strerror(errno));
+    }
+
+    map(size);
+
+    m_header->magic = SHM_RING_MAGIC;
+    m_header->capacity = capacity;
+    m_header->head = 0;
+    m_header->tail = 0;
+    m_header->waiting = 0;
+}
+
+ShmRing::ShmRing(int memfd, int eventfd)
+    : m_memfd(memfd)
+    , m_eventfd(eventfd)
+    , m_header(nullptr)
+    , m_data(nullptr)
+    , m_mappedSize(0)
+    , m_readEnd(0)
+{
+    struct stat st;
+    if (fstat(m_memfd, &st) == -1 || (size_t)st.st_size <= sizeof(Header))
+    {
+        closeFd(m_memfd);
+        closeFd(m_eventfd);
+        SWSS_LOG_THROW("invalid shm ring memfd");
+    }
+
+    map((size_t)st.st_size);
+
+    if (m_header->magic != SHM_RING_MAGIC || m_header->capacity != m_mappedSize - sizeof(Header))
+    {
+        munmap(m_header, m_mappedSize);
+        closeFd(m_memfd);
+        closeFd(m_eventfd);
+        SWSS_LOG_THROW("shm ring header mismatch");
+    }
+}
+
+ShmRing::~ShmRing()
+{
+    if (m_header)
+    {
+        munmap(m_header, m_mappedSize);
+    }
+
+    closeFd(m_memfd);
+    closeFd(m_eventfd);
+}
+
+void ShmRing::map(size_t size)
+{
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_memfd, 0);
+    if (addr == MAP_FAILED)
+    {
+        closeFd(m_memfd);
+        closeFd(m_eventfd);
+        SWSS_LOG_THROW("mmap of shm ring failed, errno: %s", strerror(errno));
+    }
+
+    m_header = static_cast<Header *>(addr);
+    m_data = static_cast<char *>(addr) + sizeof(Header);
+    m_mappedSize = size;
+}
+
+size_t ShmRing::getMaxMessageSize() const
+{
+    // a record of half the ring fits in front of or behind any position
+    return m_header->capacity / 2 - sizeof(uint64_t);
+}
+
+bool ShmRing::write(const char *data, size_t length)
+{
+    if (length > getMaxMessageSize())
+    {
+        SWSS_LOG_THROW("message of %zu bytes is too big for shm ring, max %zu", length, getMaxMessageSize());
+    }
+
+    uint64_t capacity = m_header->capacity;
+    uint64_t head = m_header->head.load(std::memory_order_relaxed);
+    uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+
+    uint64_t record = recordSize(length);
+    uint64_t pos = head % capacity;
+    uint64_t contiguous = capacity - pos;
+    uint64_t needed = (contiguous < record) ? contiguous + record : record;
+    if (capacity - (head - tail) < needed)
+    {
+        return false;
+    }
+
+    WARNINGS_NO_CAST_ALIGN;
+    if (contiguous < record)
+    {
+        *(uint64_t *)(m_data + pos) = SHM_RING_PADDING;
+        head += contiguous;
+        pos = 0;
+    }
+
+    *(uint64_t *)(m_data + pos) = length;
+    WARNINGS_RESET;
+
+    memcpy(m_data + pos + sizeof(uint64_t), data, length);
+    m_header->head.store(head + record, std::memory_order_release);
+
+    // pairs with the fence in prepareWait(): either the consumer sees the
+    // message, or this producer sees the consumer waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_header->waiting.load(std::memory_order_relaxed) &&
+        m_header->waiting.exchange(0, std::memory_order_relaxed))
+    {
+        notify();
+    }
+
+    return true;
+}
+
+bool ShmRing::read(const char *&data, size_t &length)
+{
+    uint64_t capacity = m_header->capacity;
+    uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        uint64_t head = m_header->head.load(std::memory_order_acquire);
+        if (tail == head)
+        {
+            return false;
+        }
+
+        uint64_t pos = tail % capacity;
+
+        WARNINGS_NO_CAST_ALIGN;
+        uint64_t recordLength = *(const uint64_t *)(m_data + pos);
+        WARNINGS_RESET;
+
+        if (recordLength == SHM_RING_PADDING)
+        {
+            tail += capacity - pos;
+            m_header->tail.store(tail, std::memory_order_release);
+            continue;
+        }
+
+        if (recordLength > getMaxMessageSize())
+        {
+            SWSS_LOG_THROW("shm ring is corrupted, message length %" PRIu64, recordLength);
+        }
+
+        data = m_data + pos + sizeof(uint64_t);
+        length = (size_t)recordLength;
+        m_readEnd = tail + recordSize(length);
+        return true;
+    }
+}
+
+void ShmRing::release()
+{
+    m_header->tail.store(m_readEnd, std::memory_order_release);
+}
+
+bool ShmRing::prepareWait()
+{
+    m_header->waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_header->head.load(std::memory_order_relaxed) != m_header->tail.load(std::memory_order_relaxed))
+    {
+        m_header->waiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+void ShmRing::clearEvent()
+{
+    uint64_t value;
+    ssize_t s;
+    do
+    {
+        s = ::read(m_eventfd, &value, sizeof(value));
+    }
+    while (s == -1 && errno == EINTR);
+}
+
+void ShmRing::notify()
+{
+    uint64_t value = 1;
+    ssize_t s;
+    do
+    {
+        s = ::write(m_eventfd, &value, sizeof(value));
+    }
+    while (s == -1 && errno == EINTR);
+
+    if (s != sizeof(value))
+    {
+        SWSS_LOG_ERROR("write to shm ring eventfd failed, errno: %s", strerror(errno));
+    }
+}
+
+bool ShmRing::isShmEndpoint(const std::string &endpoint)
+{
+    return endpoint.compare(0, strlen(ENDPOINT_PREFIX), ENDPOINT_PREFIX) == 0;
+}
+
+static socklen_t abstractAddress(const std::string &endpoint, struct sockaddr_un &addr)
+{
+    // abstract socket namespace, nothing is left behind in the file system
+    std::string name = "swss-shm-" + endpoint.substr(strlen(ShmRing::ENDPOINT_PREFIX));
+    if (name.length() + 1 > sizeof(addr.sun_path))
+    {
+        SWSS_LOG_THROW("shm endpoint name is too long: %s", endpoint.c_str());
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path + 1, name.c_str(), name.length());
+
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + name.length());
+}
+
+int ShmRing::listen(const std::string &endpoint)
+{
+    struct sockaddr_un addr;
+    socklen_t len = abstractAddress(endpoint, addr);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        SWSS_LOG_THROW("failed to create unix socket, errno: %s", strerror(errno));
+    }
+
+    if (::bind(fd, (struct sockaddr *)&addr, len) == -1 || ::listen(fd, SOMAXCONN) == -1)
+    {
+        int err = errno;
+        closeFd(fd);
+        SWSS_LOG_THROW("failed to listen on shm endpoint %s, errno: %s", endpoint.c_str(), strerror(err));
+    }
+
+    return fd;
+}
+
+int ShmRing::connect(const std::string &endpoint)
+{
+    struct sockaddr_un addr;
+    socklen_t len = abstractAddress(endpoint, addr);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        SWSS_LOG_THROW("failed to create unix socket, errno: %s", strerror(errno));
+    }
+
+    if (::connect(fd, (struct sockaddr *)&addr, len) == -1)
+    {
+        int err = errno;
+        closeFd(fd);
+        SWSS_LOG_THROW("failed to connect to shm endpoint %s, errno: %s", endpoint.c_str(), strerror(err));
+    }
+
+    return fd;
+}
+
+void ShmRing::sendFds(int socket, int memfd, int eventfd)
+{
+    char byte = 0;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    union
+    {
+        char buffer[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int fds[2] = { memfd, eventfd };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t s;
+    do
+    {
+        s = sendmsg(socket, &msg, MSG_NOSIGNAL);
+    }
+    while (s == -1 && errno == EINTR);
+
+    if (s != sizeof(byte))
+    {
+        SWSS_LOG_THROW("failed to send shm ring fds, errno: %s", strerror(errno));
+    }
+}
+
+void ShmRing::receiveFds(int socket, int &memfd, int &eventfd)
+{
+    char byte;
+    struct iovec iov;
+    iov.iov_base = &byte;
+    iov.iov_len = sizeof(byte);
+
+    union
+    {
+        char buffer[CMSG_SPACE(2 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    ssize_t s;
+    do
+    {
+        s = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+    }
+    while (s == -1 && errno == EINTR);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (s != sizeof(byte) || cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS
+        || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+    {
+        SWSS_LOG_THROW("failed to receive shm ring fds, errno: %s", strerror(errno));
+    }
+
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    memfd = fds[0];
+    eventfd = fds[1];
+}
+
+}
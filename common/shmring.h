@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+namespace swss {
+
+/*
+ * Single producer, single consumer ring of messages in shared memory.
+ *
+ * The consumer creates the ring in a memfd and passes the memfd and an
+ * eventfd to the producer process over a unix socket (SCM_RIGHTS), see
+ * listen(), connect(), sendFds() and receiveFds(). Messages are written as
+ * a length followed by the payload padded to 8 bytes. A message never wraps
+ * around the end of the ring, the producer pads the tail instead, so the
+ * consumer reads every payload in place.
+ *
+ * The consumer sets a waiting flag before it sleeps on the eventfd, the
+ * producer writes the eventfd only when it finds the flag set, so a busy
+ * consumer costs the producer no syscall per message.
+ */
+class ShmRing
+{
+public:
+    static constexpr const char *ENDPOINT_PREFIX = "shm://";
+
+    /* Create a ring with room for capacity bytes, consumer side */
+    explicit ShmRing(size_t capacity);
+
+    /* Attach to the ring of the given memfd, producer side, takes both fds */
+    ShmRing(int memfd, int eventfd);
+
+    ~ShmRing();
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    int getMemFd() const { return m_memfd; }
+    int getEventFd() const { return m_eventfd; }
+
+    /* Largest message that always fits eventually */
+    size_t getMaxMessageSize() const;
+
+    /* Producer: false when the ring has no room right now */
+    bool write(const char *data, size_t length);
+
+    /* Consumer: the next message, it stays valid until release() */
+    bool read(const char *&data, size_t &length);
+
+    /* Consumer: drop the message returned by read() */
+    void release();
+
+    /*
+     * Consumer: announce that it sleeps on the eventfd. Returns false when
+     * a message arrived in the meantime, then the consumer reads instead.
+     */
+    bool prepareWait();
+
+    /* Consumer: consume the eventfd wakeup */
+    void clearEvent();
+
+    static bool isShmEndpoint(const std::string &endpoint);
+
+    /* Rendezvous on an abstract unix socket named after the endpoint */
+    static int listen(const std::string &endpoint);
+    static int connect(const std::string &endpoint);
+
+    static void sendFds(int socket, int memfd, int eventfd);
+    static void receiveFds(int socket, int &memfd, int &eventfd);
+
+private:
+    struct Header
+    {
+        uint64_t magic;
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> waiting;
+    };
+
+    void map(size_t size);
+
+    void notify();
+
+    int m_memfd;
+
+    int m_eventfd;
+
+    Header *m_header;
+
+    char *m_data;
+
+    size_t m_mappedSize;
+
+    // consumer position of the message returned by read()
+    uint64_t m_readEnd;
+};
+
+}
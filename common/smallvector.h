@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+namespace swss {
+
+/*
+ * Vector with inline storage for the first N elements.
+ *
+ * Elements live in the object itself until the inline capacity is exceeded,
+ * after which all elements are moved to a heap allocated std::vector. This
+ * keeps small collections (e.g. the few field/value slices of a table entry)
+ * free of heap allocations.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() : m_size(0), m_onHeap(false) {}
+
+    void push_back(const T &value)
+    {
+        if (!m_onHeap && m_size == N)
+        {
+            spill(N * 2);
+        }
+
+        if (m_onHeap)
+        {
+            m_heap.push_back(value);
+        }
+        else
+        {
+            m_inline[m_size] = value;
+        }
+
+        m_size++;
+    }
+
+    void push_back(T &&value)
+    {
+        if (!m_onHeap && m_size == N)
+        {
+            spill(N * 2);
+        }
+
+        if (m_onHeap)
+        {
+            m_heap.push_back(std::move(value));
+        }
+        else
+        {
+            m_inline[m_size] = std::move(value);
+        }
+
+        m_size++;
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= N)
+        {
+            return;
+        }
+
+        if (m_onHeap)
+        {
+            m_heap.reserve(capacity);
+        }
+        else
+        {
+            spill(capacity);
+        }
+    }
+
+    void clear()
+    {
+        m_size = 0;
+        m_heap.clear();
+        m_onHeap = false;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool isInline() const { return !m_onHeap; }
+
+    T *data() { return m_onHeap ? m_heap.data() : m_inline; }
+    const T *data() const { return m_onHeap ? m_heap.data() : m_inline; }
+
+    T &operator[](size_t i) { return data()[i]; }
+    const T &operator[](size_t i) const { return data()[i]; }
+
+    T &back() { return data()[m_size - 1]; }
+    const T &back() const { return data()[m_size - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + m_size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + m_size; }
+
+private:
+    void spill(size_t capacity)
+    {
+        m_heap.reserve(capacity);
+        for (size_t i = 0; i < m_size; i++)
+        {
+            m_heap.push_back(std::move(m_inline[i]));
+        }
+        m_onHeap = true;
+    }
+
+    T m_inline[N];
+    std::vector<T> m_heap;
+    size_t m_size;
+    bool m_onHeap;
+};
+
+}
@@ -1,6 +1,7 @@
 #include <string>
 #include <deque>
 #include <limits>
+#include <unordered_map>
 #include <hiredis/hiredis.h>
 #include "dbconnector.h"
 #include "table.h"
@@ -9,13 +10,14 @@
 #include "redisapi.h"
 #include "tokenize.h"
 #include "subscriberstatetable.h"
+#include "keyspacedispatcher.h"
 
 using namespace std;
 
 namespace swss {
 
 SubscriberStateTable::SubscriberStateTable(DBConnector *db, const string &tableName, int popBatchSize, int pri)
-    : ConsumerTableBase(db, tableName, popBatchSize, pri), m_table(db, tableName)
+    : ConsumerTableBase(db, tableName, popBatchSize, pri), m_table(db, tableName), m_dispatcher(nullptr)
 {
     m_keyspace = "__keyspace@";
 
@@ -23,27 +25,94 @@ SubscriberStateTable::SubscriberStateTable(DBConnector *db, const string &tableN
 
     psubscribe(m_db, m_keyspace);
 
-    vector<string> keys;
-    m_table.getKeys(keys);
+    loadInitialData();
+}
+
+SubscriberStateTable::SubscriberStateTable(DBConnector *db, const string &tableName, KeyspaceDispatcher &dispatcher, int popBatchSize, int pri)
+    : ConsumerTableBase(db, tableName, popBatchSize, pri), m_table(db, tableName), m_dispatcher(&dispatcher)
+{
+    if (dispatcher.getDbId() != db->getDbId())
+    {
+        SWSS_LOG_THROW("KeyspaceDispatcher of DB %d can't serve table %s of DB %d", dispatcher.getDbId(), tableName.c_str(), db->getDbId());
+    }
+
+    m_keyspace = dispatcher.getKeyspacePattern();
+    m_dispatchEvent = make_unique<SelectableEvent>();
 
-    for (const auto &key: keys)
+    /* Register before loading the snapshot, so that no change is missed in between */
+    m_dispatcher->registerTable(tableName, this);
+
+    loadInitialData();
+}
+
+SubscriberStateTable::~SubscriberStateTable()
+{
+    if (m_dispatcher != nullptr)
     {
-        KeyOpFieldsValuesTuple kco;
+        m_dispatcher->unregisterTable(getTableName(), this);
+    }
+}
 
-        kfvKey(kco) = key;
-        kfvOp(kco) = SET_COMMAND;
+void SubscriberStateTable::detachDispatcher()
+{
+    SWSS_LOG_WARN("KeyspaceDispatcher destroyed before table %s, no more keyspace events are received", getTableName().c_str());
 
-        if (!m_table.get(key, kfvFieldsValues(kco)))
+    m_dispatcher = nullptr;
+}
+
+void SubscriberStateTable::loadInitialData()
+{
+    /* Load the initial snapshot with SCAN and pipelined HGETALL, so that
+     * neither redis nor the daemon is blocked key by key on large tables */
+    vector<string> keys;
+    m_table.scanKeys(keys);
+
+    vector<vector<FieldValueTuple>> values;
+    vector<bool> exists;
+    m_table.getEntries(keys, values, exists);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (!exists[i])
         {
             continue;
         }
 
-        m_buffer.push_back(kco);
+        m_buffer.emplace_back(keys[i], SET_COMMAND, std::move(values[i]));
+    }
+}
+
+int SubscriberStateTable::getFd()
+{
+    if (m_dispatchEvent)
+    {
+        return m_dispatchEvent->getFd();
+    }
+
+    return RedisSelect::getFd();
+}
+
+void SubscriberStateTable::pushKeyspaceEvent(const shared_ptr<RedisReply> &event)
+{
+    bool notify = m_keyspace_event_buffer.empty();
+
+    m_keyspace_event_buffer.push_back(event);
+
+    /* One wakeup is enough until the buffered events are popped */
+    if (notify)
+    {
+        m_dispatchEvent->notify();
     }
 }
 
 uint64_t SubscriberStateTable::readData()
 {
+    if (m_dispatchEvent)
+    {
+        /* Events were already buffered by the dispatcher */
+        return m_dispatchEvent->readData();
+    }
+
     redisReply *reply = nullptr;
 
     /* Read data from redis. This call is non blocking. This method
@@ -103,65 +172,197 @@ void SubscriberStateTable::pops(deque<KeyOpFieldsValuesTuple> &vkco, const strin
         return;
     }
 
-    while (auto event = popEventBuffer())
+    /* Coalesce the buffered keyspace events per key. A key that was modified
+     * many times is fetched only once, and only its latest op is reported,
+     * except that a key deleted and then set again is reported as DEL
+     * followed by SET, so consumers drop the fields it lost. Keys are
+     * reported in the order they were first seen. */
+    struct KeyEvents
     {
+        bool isDel;
+        bool delBeforeSet;
+    };
 
-        KeyOpFieldsValuesTuple kco;
-        /* if the Key-space notification is empty, try next one. */
-        auto message = event->getReply<RedisMessage>();
-        if (message.type.empty())
+    vector<string> keys;
+    unordered_map<string, KeyEvents> events;
+    while (auto event = popEventBuffer())
+    {
+        string key;
+        bool isDel;
+        if (!parseKeyspaceEvent(*event, key, isDel))
         {
             continue;
         }
 
-        /* The second element should be the original pattern matched */
-        auto ctx = event->getContext()->element[1];
-        if (message.pattern != m_keyspace)
+        auto it = events.find(key);
+        if (it == events.end())
+        {
+            events.emplace(key, KeyEvents{isDel, false});
+            keys.push_back(key);
+        }
+        else
+        {
+            if (!isDel && it->second.isDel)
+            {
+                it->second.delBeforeSet = true;
+            }
+
+            it->second.isDel = isDel;
+        }
+    }
+
+    vector<string> setKeys;
+    for (const auto &key : keys)
+    {
+        if (!events[key].isDel)
+        {
+            setKeys.push_back(key);
+        }
+    }
+
+    /* Fetch all the updated entries in pipelined batches */
+    vector<vector<FieldValueTuple>> values;
+    vector<bool> exists;
+    m_table.getEntries(setKeys, values, exists);
+
+    size_t index = 0;
+    for (const auto &key : keys)
+    {
+        const auto &keyEvents = events[key];
+        if (keyEvents.isDel || keyEvents.delBeforeSet)
+        {
+            vkco.emplace_back(key, DEL_COMMAND, vector<FieldValueTuple>());
+        }
+
+        if (keyEvents.isDel)
         {
-            SWSS_LOG_ERROR("invalid pattern %s returned for pmessage of %s", message.pattern.c_str(), m_keyspace.c_str());
             continue;
         }
 
-        string msg = message.channel;
-        size_t pos = msg.find(':');
-        if (pos == msg.npos)
+        size_t i = index++;
+        if (!exists[i])
         {
-            SWSS_LOG_ERROR("invalid format %s returned for pmessage of %s", msg.c_str(), m_keyspace.c_str());
+            SWSS_LOG_NOTICE("Miss table key %s%s%s, possibly outdated", getTableName().c_str(), m_table.getTableNameSeparator().c_str(), key.c_str());
             continue;
         }
 
-        string table_entry = msg.substr(pos + 1);
-        pos = table_entry.find(m_table.getTableNameSeparator());
-        if (pos == table_entry.npos)
+        vkco.emplace_back(key, SET_COMMAND, std::move(values[i]));
+    }
+
+    m_keyspace_event_buffer.clear();
+
+    return;
+}
+
+void SubscriberStateTable::popsDelta(deque<KeyOpFieldsValuesDelta> &deltas)
+{
+    deltas.clear();
+
+    deque<KeyOpFieldsValuesTuple> vkco;
+    pops(vkco);
+
+    for (auto &kco : vkco)
+    {
+        KeyOpFieldsValuesDelta delta;
+        delta.key = kfvKey(kco);
+        delta.op = kfvOp(kco);
+
+        auto shadowIt = m_shadow.find(delta.key);
+        if (delta.op == DEL_COMMAND)
         {
-            SWSS_LOG_ERROR("invalid key %s returned for pmessage of %s", ctx->str, m_keyspace.c_str());
+            if (shadowIt != m_shadow.end())
+            {
+                for (auto &fv : shadowIt->second)
+                {
+                    delta.fields.push_back({fv.first, make_shared<string>(fv.second), nullptr});
+                }
+
+                m_shadow.erase(shadowIt);
+            }
+
+            deltas.push_back(std::move(delta));
             continue;
         }
-        string key = table_entry.substr(pos + 1);
 
-        string op = message.data;
-        if ("del" == op)
+        if (shadowIt == m_shadow.end())
         {
-            kfvKey(kco) = key;
-            kfvOp(kco) = DEL_COMMAND;
+            shadowIt = m_shadow.emplace(delta.key, unordered_map<string, string>()).first;
         }
-        else
+
+        auto &shadow = shadowIt->second;
+        unordered_map<string, string> current;
+        for (auto &fv : kfvFieldsValues(kco))
         {
-            if (!m_table.get(key, kfvFieldsValues(kco)))
+            auto &field = fvField(fv);
+            auto &value = fvValue(fv);
+
+            auto it = shadow.find(field);
+            if (it == shadow.end())
             {
-                SWSS_LOG_NOTICE("Miss table key %s, possibly outdated", table_entry.c_str());
-                continue;
+                delta.fields.push_back({field, nullptr, make_shared<string>(value)});
+            }
+            else if (it->second != value)
+            {
+                delta.fields.push_back({field, make_shared<string>(it->second), make_shared<string>(value)});
+            }
+
+            current.emplace(field, value);
+        }
+
+        for (auto &fv : shadow)
+        {
+            if (current.find(fv.first) == current.end())
+            {
+                delta.fields.push_back({fv.first, make_shared<string>(fv.second), nullptr});
             }
-            kfvKey(kco) = key;
-            kfvOp(kco) = SET_COMMAND;
         }
 
-        vkco.push_back(kco);
+        shadow.swap(current);
+
+        if (!delta.fields.empty())
+        {
+            deltas.push_back(std::move(delta));
+        }
     }
+}
 
-    m_keyspace_event_buffer.clear();
+bool SubscriberStateTable::parseKeyspaceEvent(RedisReply &event, string &key, bool &isDel)
+{
+    /* if the Key-space notification is empty, try next one. */
+    auto message = event.getReply<RedisMessage>();
+    if (message.type.empty())
+    {
+        return false;
+    }
 
-    return;
+    /* The second element should be the original pattern matched */
+    auto ctx = event.getContext()->element[1];
+    if (message.pattern != m_keyspace)
+    {
+        SWSS_LOG_ERROR("invalid pattern %s returned for pmessage of %s", message.pattern.c_str(), m_keyspace.c_str());
+        return false;
+    }
+
+    string msg = message.channel;
+    size_t pos = msg.find(':');
+    if (pos == msg.npos)
+    {
+        SWSS_LOG_ERROR("invalid format %s returned for pmessage of %s", msg.c_str(), m_keyspace.c_str());
+        return false;
+    }
+
+    string table_entry = msg.substr(pos + 1);
+    pos = table_entry.find(m_table.getTableNameSeparator());
+    if (pos == table_entry.npos)
+    {
+        SWSS_LOG_ERROR("invalid key %s returned for pmessage of %s", ctx->str, m_keyspace.c_str());
+        return false;
+    }
+
+    key = table_entry.substr(pos + 1);
+    isDel = ("del" == message.data);
+
+    return true;
 }
 
 shared_ptr<RedisReply> SubscriberStateTable::popEventBuffer()
@@ -2,22 +2,60 @@
 
 #include <string>
 #include <deque>
+#include <vector>
+#include <unordered_map>
 #include <memory.h>
 #include "dbconnector.h"
 #include "consumertablebase.h"
+#include "selectableevent.h"
 
 namespace swss {
 
+class KeyspaceDispatcher;
+
+/* Change of a single field, reported by SubscriberStateTable::popsDelta() */
+struct FieldValueDelta
+{
+    std::string field;
+    std::shared_ptr<std::string> oldValue; // nullptr when the field was added
+    std::shared_ptr<std::string> newValue; // nullptr when the field was removed
+};
+
+struct KeyOpFieldsValuesDelta
+{
+    std::string key;
+    std::string op;
+    std::vector<FieldValueDelta> fields;
+};
+
 class SubscriberStateTable : public ConsumerTableBase
 {
 public:
     SubscriberStateTable(DBConnector *db, const std::string &tableName, int popBatchSize = DEFAULT_POP_BATCH_SIZE, int pri = 0);
 
+    /*
+     * Receive keyspace events through a shared dispatcher instead of an own
+     * subscription. The dispatcher should outlive the table, a dispatcher
+     * destroyed first detaches the table, which then receives no more events.
+     */
+    SubscriberStateTable(DBConnector *db, const std::string &tableName, KeyspaceDispatcher &dispatcher, int popBatchSize = DEFAULT_POP_BATCH_SIZE, int pri = 0);
+
+    ~SubscriberStateTable() override;
+
     /* Get all elements available */
     void pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const std::string &prefix = EMPTY_PREFIX);
 
+    /*
+       Get only the fields that changed since the previous call, with their previous values.
+       A shadow copy of every key is kept to compute the delta, so only use it on tables
+       where that memory is acceptable, and do not mix it with pops()/pop() on one table.
+       Entries whose content did not change are not reported.
+    */
+    void popsDelta(std::deque<KeyOpFieldsValuesDelta> &deltas);
+
     /* Read keyspace event from redis */
     uint64_t readData() override;
+    int getFd() override;
     bool hasData() override;
     bool hasCachedData() override;
     bool initializedWithData() override
@@ -26,13 +64,34 @@ public:
     }
 
 private:
+    friend class KeyspaceDispatcher;
+
+    void loadInitialData();
+
+    /* Called by the dispatcher when it is destroyed before the table */
+    void detachDispatcher();
+
+    /* Buffer a keyspace event routed by the dispatcher */
+    void pushKeyspaceEvent(const std::shared_ptr<RedisReply> &event);
+
     /* Pop keyspace event from event buffer. Caller should free resources. */
     std::shared_ptr<RedisReply> popEventBuffer();
 
+    /* Extract the table key and whether it was deleted from a keyspace event */
+    bool parseKeyspaceEvent(RedisReply &event, std::string &key, bool &isDel);
+
     std::string m_keyspace;
 
     std::deque<std::shared_ptr<RedisReply>> m_keyspace_event_buffer;
     Table m_table;
+
+    /* nullptr once the dispatcher is gone, m_dispatchEvent tells the mode */
+    KeyspaceDispatcher *m_dispatcher;
+
+    std::unique_ptr<SelectableEvent> m_dispatchEvent;
+
+    /* Last content delivered by popsDelta(), per key */
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> m_shadow;
 };
 
 }
@@ -1,5 +1,8 @@
 #include <hiredis/hiredis.h>
 #include <system_error>
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
 
 #include "common/table.h"
 #include "common/logger.h"
@@ -88,6 +91,70 @@ bool Table::get(const string &key, vector<FieldValueTuple> &values)
     return true;
 }
 
+void Table::getEntries(const vector<string> &keys, vector<vector<FieldValueTuple>> &values, vector<bool> &exists)
+{
+    values.clear();
+    values.resize(keys.size());
+    exists.assign(keys.size(), false);
+
+    // Replies are read straight from the connection, so nothing else may be in flight
+    m_pipe->flush();
+    redisContext *ctx = m_pipe->getDBConnector()->getContext();
+
+    for (size_t begin = 0; begin < keys.size(); begin += GET_ENTRIES_BATCH_SIZE)
+    {
+        size_t end = min(keys.size(), begin + GET_ENTRIES_BATCH_SIZE);
+        for (size_t i = begin; i < end; i++)
+        {
+            RedisCommand hgetall_key;
+            hgetall_key.format("HGETALL %s", getKeyName(keys[i]).c_str());
+            if (hgetall_key.appendTo(ctx) != REDIS_OK)
+            {
+                // The only reason of error is REDIS_ERR_OOM (Out of memory)
+                throw bad_alloc();
+            }
+        }
+
+        // Read all replies of the batch before parsing, so the connection stays in sync on error
+        vector<shared_ptr<RedisReply>> replies;
+        replies.reserve(end - begin);
+        for (size_t i = begin; i < end; i++)
+        {
+            redisReply *reply;
+            if (redisGetReply(ctx, (void**)&reply) != REDIS_OK)
+            {
+                throw RedisError("Failed to redisGetReply in Table::getEntries", ctx);
+            }
+
+            replies.push_back(make_shared<RedisReply>(reply));
+        }
+
+        for (size_t i = begin; i < end; i++)
+        {
+            auto& r = replies[i - begin];
+            r->checkReplyType(REDIS_REPLY_ARRAY);
+            redisReply *reply = r->getContext();
+
+            if (!reply->elements)
+                continue;
+
+            if (reply->elements & 1)
+                throw system_error(make_error_code(errc::address_not_available),
+                                   "Pipelined HGETALL in Table::getEntries returned an odd number of elements for key " + keys[i]);
+
+            auto& fvs = values[i];
+            fvs.reserve(reply->elements / 2);
+            for (unsigned int j = 0; j < reply->elements; j += 2)
+            {
+                fvs.emplace_back(stripSpecialSym(reply->element[j]->str),
+                                        string(reply->element[j + 1]->str, reply->element[j + 1]->len));
+            }
+
+            exists[i] = true;
+        }
+    }
+}
+
 bool Table::hget(const string &key, const std::string &field,  std::string &value)
 {
     RedisCommand hget_entry;
@@ -220,6 +287,34 @@ void Table::getKeys(vector<string> &keys)
     }
 }
 
+void Table::scanKeys(vector<string> &keys, uint32_t count)
+{
+    string match = getTableName() + getTableNameSeparator() + "*";
+    size_t prefixLen = getTableName().length() + getTableNameSeparator().length();
+    unordered_set<string> seen;
+    keys.clear();
+
+    m_pipe->flush();
+    DBConnector *db = m_pipe->getDBConnector();
+
+    int cursor = 0;
+    do
+    {
+        auto r = db->scan(cursor, match.c_str(), count);
+        cursor = r.first;
+
+        // SCAN may return the same key more than once
+        for (auto &key : r.second)
+        {
+            if (seen.insert(key).second)
+            {
+                keys.push_back(key.substr(prefixLen));
+            }
+        }
+    }
+    while (cursor != 0);
+}
+
 void Table::dump(TableDump& tableDump)
 {
     SWSS_LOG_ENTER();
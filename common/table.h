@@ -188,6 +188,9 @@ static constexpr int64_t DEFAULT_DB_TTL = -1;
 
 class Table : public TableBase, public TableEntryEnumerable {
 public:
+    /* Max number of commands in flight for the pipelined getEntries() */
+    static constexpr size_t GET_ENTRIES_BATCH_SIZE = 128;
+
     Table(const DBConnector *db, const std::string &tableName);
     Table(RedisPipeline *pipeline, const std::string &tableName, bool buffered);
     ~Table() override;
@@ -232,6 +235,13 @@ public:
     virtual bool get(const std::string &key, std::vector<FieldValueTuple> &ovalues);
 
     virtual bool hget(const std::string &key, const std::string &field,  std::string &value);
+
+    /* Read multiple entries from the DB directly, HGETALL commands are pipelined in batches */
+    /* exists[i] is false if keys[i] doesn't exist */
+    void getEntries(const std::vector<std::string> &keys,
+                    std::vector<std::vector<FieldValueTuple>> &values,
+                    std::vector<bool> &exists);
+
     virtual void hset(const std::string &key,
                           const std::string &field,
                           const std::string &value,
@@ -240,6 +250,9 @@ public:
 
     void getKeys(std::vector<std::string> &keys);
 
+    /* Same as getKeys(), but iterates with SCAN so that redis is not blocked on large tables */
+    void scanKeys(std::vector<std::string> &keys, uint32_t count = GET_ENTRIES_BATCH_SIZE);
+
     void setBuffered(bool buffered);
 
     void flush();
@@ -0,0 +1,336 @@
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "common/logger.h"
+#include "common/timerwheel.h"
+
+namespace swss {
+
+WheelTimer::WheelTimer(TimerWheel &wheel, const timespec& interval)
+    : m_wheel(wheel)
+    , m_intervalTicks(1)
+    , m_expires(0)
+    , m_running(false)
+    , m_pending(false)
+    , m_prev(NULL)
+    , m_next(NULL)
+    , m_slot(NULL)
+{
+    setInterval(interval);
+}
+
+WheelTimer::~WheelTimer()
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    m_wheel.stopTimer(this);
+}
+
+void WheelTimer::start()
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    m_wheel.startTimer(this);
+}
+
+void WheelTimer::stop()
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    m_wheel.stopTimer(this);
+}
+
+void WheelTimer::reset()
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    m_wheel.stopTimer(this);
+    m_wheel.startTimer(this);
+}
+
+void WheelTimer::setInterval(const timespec& interval)
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    m_intervalTicks = m_wheel.toTicks(interval);
+}
+
+bool WheelTimer::isRunning()
+{
+    std::lock_guard<std::mutex> lock(m_wheel.m_mutex);
+    return m_running;
+}
+
+TimerWheel::TimerWheel(const timespec& tick, int pri)
+    : Selectable(pri)
+    , m_tick(tick)
+    , m_armed(false)
+    , m_now(0)
+    , m_timerCount(0)
+{
+    m_tickNs = static_cast<uint64_t>(tick.tv_sec) * 1000000000ULL + static_cast<uint64_t>(tick.tv_nsec);
+    if (tick.tv_sec < 0 || tick.tv_nsec < 0 || m_tickNs == 0)
+    {
+        SWSS_LOG_THROW("invalid timer wheel tick");
+    }
+
+    std::fill(m_root, m_root + ROOT_SIZE, nullptr);
+    for (auto &level : m_levels)
+    {
+        std::fill(level, level + LEVEL_SIZE, nullptr);
+    }
+
+    m_tfd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (m_tfd == -1)
+    {
+        SWSS_LOG_THROW("failed to create timerfd, errno: %s", strerror(errno));
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    int err;
+
+    do
+    {
+        err = close(m_tfd);
+    }
+    while(err == -1 && errno == EINTR);
+}
+
+int TimerWheel::getFd()
+{
+    return m_tfd;
+}
+
+uint64_t TimerWheel::readData()
+{
+    uint64_t cnt = 0;
+
+    ssize_t ret;
+    errno = 0;
+    do
+    {
+        ret = read(m_tfd, &cnt, sizeof(uint64_t));
+    }
+    while(ret == -1 && errno == EINTR);
+
+    ABORT_IF_NOT((ret == 0) || (ret == sizeof(uint64_t)), "Failed to read timerfd. ret=%zd", ret);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // cnt = count of ticks happened since last read.
+    for (uint64_t i = 0; i < cnt; i++)
+    {
+        advance();
+    }
+
+    if (m_timerCount == 0 && m_armed)
+    {
+        arm(false);
+    }
+
+    return cnt;
+}
+
+bool TimerWheel::hasData()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_expired.empty();
+}
+
+void TimerWheel::pops(std::vector<WheelTimer *> &expired)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    expired.clear();
+    expired.reserve(m_expired.size());
+    for (auto timer : m_expired)
+    {
+        timer->m_pending = false;
+        expired.push_back(timer);
+    }
+    m_expired.clear();
+}
+
+size_t TimerWheel::getTimerCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timerCount;
+}
+
+uint64_t TimerWheel::toTicks(const timespec& interval) const
+{
+    uint64_t ns = static_cast<uint64_t>(interval.tv_sec) * 1000000000ULL + static_cast<uint64_t>(interval.tv_nsec);
+    return std::max<uint64_t>((ns + m_tickNs - 1) / m_tickNs, 1);
+}
+
+void TimerWheel::startTimer(WheelTimer *timer)
+{
+    if (timer->m_running)
+    {
+        return;
+    }
+
+    // m_now is processed by the next tick
+    timer->m_expires = m_now + timer->m_intervalTicks - 1;
+    timer->m_running = true;
+    schedule(timer);
+    m_timerCount++;
+
+    if (!m_armed)
+    {
+        arm(true);
+    }
+}
+
+void TimerWheel::stopTimer(WheelTimer *timer)
+{
+    if (timer->m_pending)
+    {
+        m_expired.erase(std::find(m_expired.begin(), m_expired.end(), timer));
+        timer->m_pending = false;
+    }
+
+    if (!timer->m_running)
+    {
+        return;
+    }
+
+    unlink(timer);
+    timer->m_running = false;
+    m_timerCount--;
+}
+
+void TimerWheel::schedule(WheelTimer *timer)
+{
+    uint64_t expires = timer->m_expires;
+    WheelTimer **slot;
+
+    if (expires < m_now)
+    {
+        slot = &m_root[m_now & (ROOT_SIZE - 1)];
+    }
+    else if (expires - m_now < ROOT_SIZE)
+    {
+        slot = &m_root[expires & (ROOT_SIZE - 1)];
+    }
+    else
+    {
+        if (expires - m_now >= MAX_TICKS)
+        {
+            // park in the last level, the timer is cascaded again later
+            expires = m_now + MAX_TICKS - 1;
+        }
+
+        unsigned int level = 0;
+        while (expires - m_now >= (1ULL << (ROOT_BITS + (level + 1) * LEVEL_BITS)))
+        {
+            level++;
+        }
+
+        slot = &m_levels[level][(expires >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1)];
+    }
+
+    timer->m_slot = slot;
+    timer->m_prev = NULL;
+    timer->m_next = *slot;
+    if (*slot)
+    {
+        (*slot)->m_prev = timer;
+    }
+    *slot = timer;
+}
+
+void TimerWheel::unlink(WheelTimer *timer)
+{
+    if (timer->m_prev)
+    {
+        timer->m_prev->m_next = timer->m_next;
+    }
+    else
+    {
+        *timer->m_slot = timer->m_next;
+    }
+
+    if (timer->m_next)
+    {
+        timer->m_next->m_prev = timer->m_prev;
+    }
+
+    timer->m_prev = NULL;
+    timer->m_next = NULL;
+    timer->m_slot = NULL;
+}
+
+uint64_t TimerWheel::cascade(unsigned int level)
+{
+    uint64_t index = (m_now >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1);
+
+    WheelTimer *timer = m_levels[level][index];
+    m_levels[level][index] = NULL;
+
+    while (timer)
+    {
+        WheelTimer *next = timer->m_next;
+        schedule(timer);
+        timer = next;
+    }
+
+    return index;
+}
+
+void TimerWheel::advance()
+{
+    uint64_t index = m_now & (ROOT_SIZE - 1);
+
+    // the root wrapped, pull the timers of the next coarse slots down
+    if (index == 0)
+    {
+        for (unsigned int level = 0; level < LEVELS; level++)
+        {
+            if (cascade(level) != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    m_now++;
+
+    WheelTimer *timer = m_root[index];
+    m_root[index] = NULL;
+
+    while (timer)
+    {
+        WheelTimer *next = timer->m_next;
+
+        if (!timer->m_pending)
+        {
+            timer->m_pending = true;
+            m_expired.push_back(timer);
+        }
+
+        // periodic like SelectableTimer, fire again after the interval
+        timer->m_expires += timer->m_intervalTicks;
+        schedule(timer);
+
+        timer = next;
+    }
+}
+
+void TimerWheel::arm(bool enable)
+{
+    itimerspec spec = {{0, 0}, {0, 0}};
+    if (enable)
+    {
+        spec.it_value = m_tick;
+        spec.it_interval = m_tick;
+    }
+
+    int rc = timerfd_settime(m_tfd, 0, &spec, NULL);
+    if (rc == -1)
+    {
+        SWSS_LOG_THROW("failed to set timerfd, errno: %s", strerror(errno));
+    }
+
+    m_armed = enable;
+}
+
+}
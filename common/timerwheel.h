@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <sys/timerfd.h>
+#include "selectable.h"
+
+namespace swss {
+
+class TimerWheel;
+
+/*
+ * Logical timer driven by a TimerWheel.
+ *
+ * Offers the start/stop/reset/setInterval interface of SelectableTimer but
+ * does not own a timerfd. Like SelectableTimer the timer is periodic, it
+ * keeps firing every interval until it is stopped. The interval is rounded
+ * up to whole wheel ticks.
+ */
+class WheelTimer
+{
+public:
+    WheelTimer(TimerWheel &wheel, const timespec& interval);
+    ~WheelTimer();
+    void start();
+    void stop();
+    void reset();
+    void setInterval(const timespec& interval);
+
+    bool isRunning();
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel &m_wheel;
+    uint64_t m_intervalTicks;
+    uint64_t m_expires; // absolute wheel tick
+    bool m_running;
+    bool m_pending; // queued as expired, not popped yet
+
+    // links of the wheel slot list
+    WheelTimer *m_prev;
+    WheelTimer *m_next;
+    WheelTimer **m_slot;
+};
+
+/*
+ * Selectable managing many WheelTimers with a single timerfd.
+ *
+ * Timers are kept in a hierarchical timing wheel: 256 slots of one tick
+ * each, followed by three levels of 64 slots each covering 256, 16K and 1M
+ * ticks per slot. Starting and stopping a timer only links or unlinks it
+ * from a slot, and the timers of a coarse slot are cascaded down one level
+ * when the finer level wraps. The timerfd ticks periodically while timers
+ * are running and is disarmed when the last one stops.
+ *
+ * When the wheel is returned by Select, use pops() to get the timers that
+ * expired. WheelTimers have to be destroyed before their TimerWheel.
+ */
+class TimerWheel : public Selectable
+{
+public:
+    TimerWheel(const timespec& tick, int pri = 50);
+    ~TimerWheel() override;
+
+    int getFd() override;
+    uint64_t readData() override;
+    bool hasData() override;
+
+    /* Move the expired timers to the vector, in expiry order */
+    void pops(std::vector<WheelTimer *> &expired);
+
+    /* Number of running timers */
+    size_t getTimerCount();
+
+private:
+    friend class WheelTimer;
+
+    static constexpr unsigned int ROOT_BITS = 8;
+    static constexpr unsigned int LEVEL_BITS = 6;
+    static constexpr unsigned int LEVELS = 3;
+    static constexpr uint64_t ROOT_SIZE = 1ULL << ROOT_BITS;
+    static constexpr uint64_t LEVEL_SIZE = 1ULL << LEVEL_BITS;
+    static constexpr uint64_t MAX_TICKS = 1ULL << (ROOT_BITS + LEVELS * LEVEL_BITS);
+
+    /* All methods below expect m_mutex to be held */
+
+    uint64_t toTicks(const timespec& interval) const;
+
+    void startTimer(WheelTimer *timer);
+
+    void stopTimer(WheelTimer *timer);
+
+    /* Link the timer to the slot matching its expiry tick */
+    void schedule(WheelTimer *timer);
+
+    void unlink(WheelTimer *timer);
+
+    /* Re-schedule all timers of a coarse slot, returns the slot index */
+    uint64_t cascade(unsigned int level);
+
+    /* Process the current tick */
+    void advance();
+
+    void arm(bool enable);
+
+    std::mutex m_mutex;
+    int m_tfd;
+    timespec m_tick;
+    uint64_t m_tickNs;
+    bool m_armed;
+
+    /* Next tick to process */
+    uint64_t m_now;
+
+    size_t m_timerCount;
+
+    WheelTimer *m_root[ROOT_SIZE];
+    WheelTimer *m_levels[LEVELS][LEVEL_SIZE];
+
+    std::deque<WheelTimer *> m_expired;
+};
+
+}
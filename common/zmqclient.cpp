@@ -1,15 +1,22 @@
 #include <stdlib.h>
+#include <inttypes.h>
 #include <tuple>
+#include <random>
 #include <sstream>
 #include <utility>
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <iterator>
 #include <exception>
 #include <system_error>
 #include <zmq.h>
+#include <poll.h>
+#include <unistd.h>
 #include "zmqclient.h"
+#include "shmring.h"
 #include "binaryserializer.h"
+#include "select.h"
 
 using namespace std;
 
@@ -22,7 +29,11 @@ ZmqClient::ZmqClient(const std::string& endpoint)
 
 ZmqClient::~ZmqClient()
 {
+    stopAsyncSend();
+
     std::lock_guard<std::mutex> lock(m_socketMutex);
+    disconnectShm();
+
     if (m_socket)
     {
         int rc = zmq_close(m_socket);
@@ -45,6 +56,21 @@ void ZmqClient::initialize(const std::string& endpoint)
     m_endpoint = endpoint;
     m_context = nullptr;
     m_socket = nullptr;
+    m_shmSocket = -1;
+    m_queueDepth = 0;
+    m_queueHighWatermark = 0;
+    m_backPressureCount = 0;
+    m_sequenceNumbers = false;
+    m_compressThreshold = 0;
+    m_wireVersion = BinarySerializer::WIRE_VERSION_1;
+    m_ackMode = false;
+    m_maxInFlight = MQ_ACK_MAX_IN_FLIGHT;
+    m_lastBatchId = 0;
+    m_failedBatchCount = 0;
+
+    // identifies this client's numbering, the server restarts it on a new id
+    std::random_device random;
+    m_producerId = ((uint64_t)random() << 32) | random();
 
     connect();
 }
@@ -63,6 +89,13 @@ void ZmqClient::connect()
     }
 
     std::lock_guard<std::mutex> lock(m_socketMutex);
+    if (ShmRing::isShmEndpoint(m_endpoint))
+    {
+        // a server that is not up yet is connected on the first send
+        connectShm();
+        return;
+    }
+
     if (m_socket)
     {
         int rc = zmq_close(m_socket);
@@ -79,7 +112,7 @@ void ZmqClient::connect()
     
     // ZMQ Client/Server are n:1 mapping, so need use PUSH/PULL pattern http://api.zeromq.org/master:zmq-socket
     m_context = zmq_ctx_new();
-    m_socket = zmq_socket(m_context, ZMQ_PUSH);
+    m_socket = zmq_socket(m_context, m_ackMode ? ZMQ_DEALER : ZMQ_PUSH);
     
     // timeout all pending send package, so zmq will not block in dtor of this class: http://api.zeromq.org/master:zmq-setsockopt
     int linger = 0;
@@ -102,27 +135,710 @@ void ZmqClient::connect()
     m_connected = true;
 }
 
+void ZmqClient::connectShm()
+{
+    disconnectShm();
+
+    int socket = -1;
+    try
+    {
+        socket = ShmRing::connect(m_endpoint);
+
+        int memfd;
+        int eventfd;
+        ShmRing::receiveFds(socket, memfd, eventfd);
+        m_shmRing.reset(new ShmRing(memfd, eventfd));
+    }
+    catch (const std::exception& e)
+    {
+        if (socket != -1)
+        {
+            close(socket);
+        }
+
+        SWSS_LOG_WARN("failed to connect to shm endpoint %s: %s", m_endpoint.c_str(), e.what());
+        return;
+    }
+
+    SWSS_LOG_NOTICE("connect to shm endpoint: %s", m_endpoint.c_str());
+    m_shmSocket = socket;
+    m_connected = true;
+}
+
+void ZmqClient::disconnectShm()
+{
+    m_shmRing.reset();
+    if (m_shmSocket != -1)
+    {
+        close(m_shmSocket);
+        m_shmSocket = -1;
+    }
+
+    m_connected = false;
+}
+
+bool ZmqClient::shmPeerClosed()
+{
+    struct pollfd pfd;
+    pfd.fd = m_shmSocket;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    // the server never writes to the socket, readable means it was closed
+    return poll(&pfd, 1, 0) > 0;
+}
+
+void ZmqClient::sendShm(const char* buffer, size_t length)
+{
+    int retry_delay = 10;
+    for (int i = 0; i <= MQ_MAX_RETRY; ++i)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_socketMutex);
+            if (!m_shmRing)
+            {
+                connectShm();
+            }
+
+            if (m_shmRing)
+            {
+                if (m_shmRing->write(buffer, length))
+                {
+                    SWSS_LOG_DEBUG("shm sended %zu bytes", length);
+                    return;
+                }
+
+                if (shmPeerClosed())
+                {
+                    SWSS_LOG_WARN("shm server went away, endpoint: %s", m_endpoint.c_str());
+                    disconnectShm();
+                }
+            }
+        }
+
+        // sleep (2 ^ retry time) * 10 ms
+        retry_delay *= 2;
+        SWSS_LOG_WARN("shm ring is full or not connected, will retry in %d ms, endpoint: %s", retry_delay, m_endpoint.c_str());
+        usleep(retry_delay * 1000);
+    }
+
+    auto message =  "shm send failed, endpoint: " + m_endpoint + ", msg length:" + to_string(length);
+    SWSS_LOG_ERROR("%s", message.c_str());
+    throw system_error(make_error_code(errc::io_error), message);
+}
+
+void ZmqClient::sendMsg(
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos)
+{
+    if (m_asyncQueue)
+    {
+        enqueue(dbName, tableName, kcos);
+        return;
+    }
+
+    auto buffer = acquireBuffer();
+    try
+    {
+        serializeAndSend(dbName, tableName, kcos, *buffer);
+    }
+    catch (...)
+    {
+        releaseBuffer(std::move(buffer));
+        throw;
+    }
+
+    releaseBuffer(std::move(buffer));
+}
+
 void ZmqClient::sendMsg(
         const std::string& dbName,
         const std::string& tableName,
         const std::vector<KeyOpFieldsValuesTuple>& kcos,
         std::vector<char>& sendbuffer)
 {
-    int serializedlen = (int)BinarySerializer::serializeBuffer(
-                                                        sendbuffer.data(),
-                                                        sendbuffer.size(),
-                                                        dbName,
-                                                        tableName,
-                                                        kcos);
+    if (m_asyncQueue)
+    {
+        enqueue(dbName, tableName, kcos);
+        return;
+    }
 
-    if (serializedlen >= MQ_RESPONSE_MAX_COUNT)
+    serializeAndSend(dbName, tableName, kcos, sendbuffer);
+}
+
+void ZmqClient::serializeAndSend(
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos,
+        std::vector<char>& sendbuffer)
+{
+    size_t headerlen = getMessageHeaderSize();
+
+    // Check the size before serializing, the server can't receive bigger messages.
+    size_t serializedlen = headerlen + BinarySerializer::serializedSize(dbName, tableName, kcos, m_wireVersion);
+    if (serializedlen >= getMaxSerializedSize())
     {
-        SWSS_LOG_THROW("ZmqClient sendMsg message was too big (buffer size %d bytes, got %d), reduce the message size, message DROPPED",
-                MQ_RESPONSE_MAX_COUNT,
+        SWSS_LOG_THROW("ZmqClient sendMsg message was too big (buffer size %zu bytes, got %zu), reduce the message size, message DROPPED",
+                getMaxSerializedSize(),
                 serializedlen);
     }
 
+    if (sendbuffer.size() < serializedlen)
+    {
+        sendbuffer.resize(serializedlen);
+    }
+
+    serializedlen = headerlen + BinarySerializer::serializeBuffer(
+                                                sendbuffer.data() + headerlen,
+                                                sendbuffer.size() - headerlen,
+                                                dbName,
+                                                tableName,
+                                                kcos,
+                                                m_wireVersion);
+
+    if (m_compressThreshold == 0 || serializedlen - headerlen < m_compressThreshold)
+    {
+        sendMessage(dbName, tableName, sendbuffer.data(), serializedlen, 0);
+        return;
+    }
+
+    // Keep the message as is when compression doesn't make it smaller.
+    auto compressed = acquireBuffer();
+    try
+    {
+        if (compressed->size() < serializedlen)
+        {
+            compressed->resize(serializedlen);
+        }
+
+        size_t compressedlen = BinarySerializer::compressBody(
+                                                sendbuffer.data() + headerlen,
+                                                serializedlen - headerlen,
+                                                compressed->data() + headerlen,
+                                                serializedlen - headerlen - 1);
+        if (compressedlen == 0)
+        {
+            sendMessage(dbName, tableName, sendbuffer.data(), serializedlen, 0);
+        }
+        else
+        {
+            SWSS_LOG_DEBUG("compressed %zu bytes to %zu", serializedlen - headerlen, compressedlen);
+            sendMessage(dbName, tableName, compressed->data(), headerlen + compressedlen, BinarySerializer::FLAG_COMPRESSED);
+        }
+    }
+    catch (...)
+    {
+        releaseBuffer(std::move(compressed));
+        throw;
+    }
+
+    releaseBuffer(std::move(compressed));
+}
+
+void ZmqClient::sendMessage(
+        const std::string& dbName,
+        const std::string& tableName,
+        char* message,
+        size_t length,
+        uint64_t flags)
+{
+    if (length >= MQ_RESPONSE_MAX_COUNT)
+    {
+        SWSS_LOG_THROW("ZmqClient sendMsg message was too big after compression (buffer size %d bytes, got %zu), reduce the message size, message DROPPED",
+                MQ_RESPONSE_MAX_COUNT,
+                length);
+    }
+
+    if (getMessageHeaderSize() == 0)
+    {
+        sendBuffer(message, length);
+        return;
+    }
+
+    BinarySerializer::MessageHeader header;
+    header.flags = flags;
+    header.producerId = m_producerId;
+    if (!m_sequenceNumbers)
+    {
+        BinarySerializer::serializeMessageHeader(message, header);
+        sendBuffer(message, length);
+        return;
+    }
+
+    header.flags |= BinarySerializer::FLAG_SEQUENCE;
+    BinarySerializer::serializeMessageHeader(message, header);
+
+    // A message that fails to send keeps its number, the server sees the gap.
+    std::lock_guard<std::mutex> lock(m_sequenceMutex);
+    auto& sequence = m_sequences[dbName + ":" + tableName];
+    BinarySerializer::setMessageSequence(message, ++sequence);
+    sendBuffer(message, length);
+}
+
+size_t ZmqClient::getMessageHeaderSize() const
+{
+    return (m_sequenceNumbers || m_compressThreshold > 0) ? BinarySerializer::MESSAGE_HEADER_SIZE : 0;
+}
+
+size_t ZmqClient::getMaxSerializedSize() const
+{
+    return m_compressThreshold > 0 ? MQ_DECOMPRESSED_MAX_COUNT : MQ_RESPONSE_MAX_COUNT;
+}
+
+void ZmqClient::enableCompression(size_t threshold)
+{
+    // a compressed body is never empty
+    m_compressThreshold = std::max(threshold, (size_t)1);
+
+    SWSS_LOG_NOTICE("Compression enabled, endpoint: %s, threshold: %zu", m_endpoint.c_str(), m_compressThreshold);
+}
+
+void ZmqClient::enableCompactWireFormat()
+{
+    m_wireVersion = BinarySerializer::WIRE_VERSION_2;
+
+    SWSS_LOG_NOTICE("Compact wire format enabled, endpoint: %s", m_endpoint.c_str());
+}
+
+void ZmqClient::enableSequenceNumbers()
+{
+    m_sequenceNumbers = true;
+
+    SWSS_LOG_NOTICE("Sequence numbers enabled, endpoint: %s, producer id: %" PRIx64, m_endpoint.c_str(), m_producerId);
+}
+
+void ZmqClient::enableAcks(size_t maxInFlight)
+{
+    if (ShmRing::isShmEndpoint(m_endpoint))
+    {
+        SWSS_LOG_THROW("Acks are not supported on shm endpoint: %s", m_endpoint.c_str());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_socketMutex);
+        m_ackMode = true;
+        m_maxInFlight = std::max(maxInFlight, (size_t)1);
+        m_connected = false;
+    }
+
+    // reconnect with a DEALER socket
+    connect();
+
+    SWSS_LOG_NOTICE("Acks enabled, endpoint: %s, max in flight: %zu", m_endpoint.c_str(), m_maxInFlight);
+}
+
+bool ZmqClient::waitForAcks(int timeoutMs)
+{
+    flush();
+
+    // poll in short steps, other threads may send meanwhile
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true)
+    {
+        std::lock_guard<std::mutex> lock(m_socketMutex);
+        if (m_inFlight.empty())
+        {
+            break;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+        {
+            SWSS_LOG_WARN("zmq acks timed out, endpoint: %s, in flight: %zu", m_endpoint.c_str(), m_inFlight.size());
+            return false;
+        }
+
+        receiveAcks((int)std::min<int64_t>(remaining, 10));
+    }
+
+    std::lock_guard<std::mutex> lock(m_socketMutex);
+    if (m_failedBatchCount > 0)
+    {
+        auto message = "zmq server failed to handle " + to_string(m_failedBatchCount) + " messages, endpoint: " + m_endpoint;
+        m_failedBatchCount = 0;
+        SWSS_LOG_ERROR("%s", message.c_str());
+        throw system_error(make_error_code(errc::io_error), message);
+    }
+
+    return true;
+}
+
+size_t ZmqClient::getInFlightCount()
+{
+    std::lock_guard<std::mutex> lock(m_socketMutex);
+    return m_inFlight.size();
+}
+
+bool ZmqClient::receiveAcks(int timeoutMs)
+{
+    zmq_pollitem_t poll_item;
+    poll_item.fd = 0;
+    poll_item.socket = m_socket;
+    poll_item.events = ZMQ_POLLIN;
+    poll_item.revents = 0;
+
+    int rc = zmq_poll(&poll_item, 1, timeoutMs);
+    if (rc <= 0 || !(poll_item.revents & ZMQ_POLLIN))
+    {
+        return false;
+    }
+
+    uint64_t ack[2];
+    bool received = false;
+    while (true)
+    {
+        rc = zmq_recv(m_socket, ack, sizeof(ack), ZMQ_DONTWAIT);
+        if (rc < 0)
+        {
+            break;
+        }
+
+        if (rc != (int)sizeof(ack))
+        {
+            SWSS_LOG_WARN("zmq received malformed ack of %d bytes, endpoint: %s", rc, m_endpoint.c_str());
+            continue;
+        }
+
+        received = true;
+        m_inFlight.erase(ack[0]);
+        if (ack[1] != MQ_ACK_OK)
+        {
+            m_failedBatchCount++;
+            SWSS_LOG_WARN("zmq server failed to handle message %" PRIu64 ", endpoint: %s", ack[0], m_endpoint.c_str());
+        }
+    }
+
+    return received;
+}
+
+void ZmqClient::waitForAckWindow()
+{
+    // a server that restarted never acks, give up on those after the timeout
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MQ_ACK_TIMEOUT_MS);
+    std::lock_guard<std::mutex> lock(m_socketMutex);
+    while (m_inFlight.size() >= m_maxInFlight)
+    {
+        if (receiveAcks(MQ_POLL_TIMEOUT))
+        {
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(MQ_ACK_TIMEOUT_MS);
+        }
+        else if (std::chrono::steady_clock::now() >= deadline)
+        {
+            auto message = "zmq acks timed out, endpoint: " + m_endpoint + ", in flight: " + to_string(m_inFlight.size());
+            m_failedBatchCount += m_inFlight.size();
+            m_inFlight.clear();
+            SWSS_LOG_ERROR("%s", message.c_str());
+            throw system_error(make_error_code(errc::timed_out), message);
+        }
+    }
+}
+
+void ZmqClient::enableAsyncSend(size_t queueSize, BackPressureHandler handler)
+{
+    if (m_asyncQueue)
+    {
+        SWSS_LOG_THROW("Async send is already enabled, endpoint: %s", m_endpoint.c_str());
+    }
+
+    m_backPressureHandler = handler;
+    m_asyncQueue = std::make_unique<SelectableQueue<AsyncMessage>>(queueSize);
+    m_flushThread = std::make_shared<std::thread>(&ZmqClient::flushThread, this);
+
+    SWSS_LOG_NOTICE("Async send enabled, endpoint: %s, queue size: %zu", m_endpoint.c_str(), m_asyncQueue->capacity());
+}
+
+void ZmqClient::flush()
+{
+    if (!m_asyncQueue)
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_flushMutex);
+        m_flushCv.wait(lock, [this]() { return m_queueDepth == 0; });
+    }
+
+    checkAsyncError();
+}
+
+size_t ZmqClient::getQueueDepth()
+{
+    return m_queueDepth;
+}
+
+size_t ZmqClient::getQueueHighWatermark()
+{
+    return m_queueHighWatermark;
+}
+
+uint64_t ZmqClient::getBackPressureCount()
+{
+    return m_backPressureCount;
+}
+
+void ZmqClient::enqueue(
+        const std::string& dbName,
+        const std::string& tableName,
+        const std::vector<KeyOpFieldsValuesTuple>& kcos)
+{
+    checkAsyncError();
+
+    // Too big messages fail on the caller, like in synchronous mode.
+    AsyncMessage message;
+    message.size = getMessageHeaderSize() + BinarySerializer::serializedSize(dbName, tableName, kcos, m_wireVersion);
+    if (message.size >= getMaxSerializedSize())
+    {
+        SWSS_LOG_THROW("ZmqClient sendMsg message was too big (buffer size %zu bytes, got %zu), reduce the message size, message DROPPED",
+                getMaxSerializedSize(),
+                message.size);
+    }
+
+    message.dbName = dbName;
+    message.tableName = tableName;
+    message.kcos = kcos;
+
+    // Count before pushing, so the flusher never sees the depth go below 0.
+    size_t depth = ++m_queueDepth;
+    size_t highWatermark = m_queueHighWatermark;
+    while (depth > highWatermark && !m_queueHighWatermark.compare_exchange_weak(highWatermark, depth))
+    {
+    }
+
+    if (m_asyncQueue->push(std::move(message)))
+    {
+        return;
+    }
+
+    m_backPressureCount++;
+    SWSS_LOG_WARN("zmq async queue is full, endpoint: %s, depth: %zu", m_endpoint.c_str(), depth);
+    if (m_backPressureHandler)
+    {
+        m_backPressureHandler(depth);
+    }
+
+    // push() leaves the message alone when the queue is full
+    int retry_delay = 10;
+    while (!m_asyncQueue->push(std::move(message)))
+    {
+        usleep(retry_delay);
+        retry_delay = std::min(retry_delay * 2, 1000);
+    }
+}
+
+void ZmqClient::flushThread()
+{
+    SWSS_LOG_ENTER();
+    SWSS_LOG_NOTICE("flushThread begin, endpoint: %s", m_endpoint.c_str());
+
+    Select select;
+    select.addSelectable(m_asyncQueue.get());
+    select.addSelectable(&m_stopEvent);
+
+    bool stop = false;
+    int backoffMs = 0;
+    std::vector<AsyncMessage> messages;
+    while (!stop || !m_asyncQueue->empty())
+    {
+        Selectable *sel;
+        int ret = select.select(&sel);
+        if (ret != Select::OBJECT)
+        {
+            // Don't spin on a failing select: report the error to the callers
+            // like a send error, then wait for the stop event with a backoff
+            // and keep draining the queue without select.
+            backoffMs = std::min(std::max(backoffMs * 2, 10), 1000);
+            SWSS_LOG_ERROR("flushThread select failed: %s, endpoint: %s, retry in %d ms",
+                    Select::resultToString(ret).c_str(),
+                    m_endpoint.c_str(),
+                    backoffMs);
+
+            {
+                std::lock_guard<std::mutex> lock(m_flushMutex);
+                if (!m_asyncError)
+                {
+                    m_asyncError = std::make_exception_ptr(std::system_error(
+                            std::make_error_code(std::errc::io_error),
+                            "ZmqClient flush thread select failed: " + Select::resultToString(ret)));
+                }
+            }
+            m_flushCv.notify_all();
+
+            struct pollfd pfd = { m_stopEvent.getFd(), POLLIN, 0 };
+            if (poll(&pfd, 1, backoffMs) > 0)
+            {
+                m_stopEvent.readData();
+                stop = true;
+            }
+
+            m_asyncQueue->pops(messages, MQ_ASYNC_BATCH_SIZE);
+            if (!messages.empty())
+            {
+                sendAsyncMessages(messages);
+            }
+            continue;
+        }
+
+        backoffMs = 0;
+
+        if (sel == &m_stopEvent)
+        {
+            // send what is queued before leaving
+            stop = true;
+            continue;
+        }
+
+        m_asyncQueue->pops(messages, MQ_ASYNC_BATCH_SIZE);
+        if (!messages.empty())
+        {
+            sendAsyncMessages(messages);
+        }
+    }
+
+    SWSS_LOG_NOTICE("flushThread end, endpoint: %s", m_endpoint.c_str());
+}
+
+void ZmqClient::sendAsyncMessages(std::vector<AsyncMessage>& messages)
+{
+    auto sendbuffer = acquireBuffer();
+    std::vector<KeyOpFieldsValuesTuple> kcos;
+
+    // Merge consecutive batches of one table, the order of all batches is kept.
+    size_t begin = 0;
+    while (begin < messages.size())
+    {
+        auto& first = messages[begin];
+        size_t size = first.size;
+        size_t end = begin + 1;
+        kcos.swap(first.kcos);
+        while (end < messages.size()
+               && messages[end].dbName == first.dbName
+               && messages[end].tableName == first.tableName
+               && size + messages[end].size < MQ_RESPONSE_MAX_COUNT)
+        {
+            size += messages[end].size;
+            std::move(messages[end].kcos.begin(), messages[end].kcos.end(), std::back_inserter(kcos));
+            end++;
+        }
+
+        try
+        {
+            serializeAndSend(first.dbName, first.tableName, kcos, *sendbuffer);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_asyncError = std::current_exception();
+        }
+
+        kcos.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_queueDepth -= end - begin;
+        }
+
+        m_flushCv.notify_all();
+        begin = end;
+    }
+
+    releaseBuffer(std::move(sendbuffer));
+}
+
+void ZmqClient::checkAsyncError()
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        error = m_asyncError;
+        m_asyncError = nullptr;
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ZmqClient::stopAsyncSend()
+{
+    if (!m_flushThread)
+    {
+        return;
+    }
+
+    m_stopEvent.notify();
+    m_flushThread->join();
+    m_flushThread = nullptr;
+}
+
+size_t ZmqClient::getPooledBufferCount()
+{
+    std::lock_guard<std::mutex> lock(m_bufferPoolMutex);
+    return m_bufferPool.size();
+}
+
+size_t ZmqClient::getPooledBufferBytes()
+{
+    std::lock_guard<std::mutex> lock(m_bufferPoolMutex);
+    size_t bytes = 0;
+    for (auto& buffer : m_bufferPool)
+    {
+        bytes += buffer->capacity();
+    }
+
+    return bytes;
+}
+
+std::unique_ptr<std::vector<char>> ZmqClient::acquireBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_bufferPoolMutex);
+        if (!m_bufferPool.empty())
+        {
+            auto buffer = std::move(m_bufferPool.back());
+            m_bufferPool.pop_back();
+            return buffer;
+        }
+    }
+
+    return std::make_unique<std::vector<char>>();
+}
+
+void ZmqClient::releaseBuffer(std::unique_ptr<std::vector<char>> buffer)
+{
+    // A rare huge batch shouldn't pin its buffer for the lifetime of the client.
+    if (buffer->capacity() > MQ_SEND_BUFFER_KEEP_SIZE)
+    {
+        std::vector<char>().swap(*buffer);
+    }
+
+    std::lock_guard<std::mutex> lock(m_bufferPoolMutex);
+    if (m_bufferPool.size() < MQ_SEND_BUFFER_POOL_SIZE)
+    {
+        m_bufferPool.push_back(std::move(buffer));
+    }
+}
+
+void ZmqClient::sendBuffer(const char* buffer, size_t length)
+{
+    if (ShmRing::isShmEndpoint(m_endpoint))
+    {
+        sendShm(buffer, length);
+        return;
+    }
+
+    int serializedlen = (int)length;
     SWSS_LOG_DEBUG("sending: %d", serializedlen);
+
+    // in ack mode every message is preceded by its batch id frame
+    uint64_t batchId = 0;
+    if (m_ackMode)
+    {
+        waitForAckWindow();
+    }
+
     int zmq_err = 0;
     int retry_delay = 10;
     int rc = 0;
@@ -132,8 +848,29 @@ void ZmqClient::sendMsg(
             // ZMQ socket is not thread safe: http://api.zeromq.org/2-1:zmq
             std::lock_guard<std::mutex> lock(m_socketMutex);
 
+            rc = 0;
+            if (m_ackMode)
+            {
+                if (batchId == 0)
+                {
+                    batchId = ++m_lastBatchId;
+                }
+
+                // the parts after the first one of a message are always queued
+                rc = zmq_send(m_socket, &batchId, sizeof(batchId), ZMQ_NOBLOCK | ZMQ_SNDMORE);
+            }
+
             // Use none block mode to use all bandwidth: http://api.zeromq.org/2-1%3Azmq-send
-            rc = zmq_send(m_socket, sendbuffer.data(), serializedlen, ZMQ_NOBLOCK);
+            if (rc >= 0)
+            {
+                rc = zmq_send(m_socket, buffer, length, ZMQ_NOBLOCK);
+            }
+
+            if (rc >= 0 && m_ackMode)
+            {
+                m_inFlight.insert(batchId);
+                receiveAcks(0);
+            }
         }
 
         if (rc >= 0)
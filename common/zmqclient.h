@@ -1,31 +1,181 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <vector>
 #include <queue>
+#include <set>
 #include <thread> 
 #include <mutex> 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
 #include "zmqserver.h"
+#include "selectableevent.h"
+#include "selectablequeue.h"
 
 namespace swss {
 
+class ShmRing;
+
 class ZmqClient
 {
 public:
+    /* Called on the sending thread when the async queue is full, before it waits for room */
+    typedef std::function<void(size_t queueDepth)> BackPressureHandler;
+
+    /* An endpoint "shm://<name>" sends through a shared memory ring to a ZmqServer on the same host */
     ZmqClient(const std::string& endpoint);
     ~ZmqClient();
 
+    /*
+     * Switch to asynchronous sending, call it before the first send.
+     *
+     * sendMsg() then only checks the message size and queues the batch. A
+     * background thread drains the queue, merges consecutive batches of the
+     * same table into one message and sends it, so a slow receiver delays
+     * the flusher instead of the caller. When the queue is full the caller
+     * waits for room after calling the back pressure handler. A send error
+     * of the flusher is thrown from the next sendMsg() or flush().
+     */
+    void enableAsyncSend(size_t queueSize = MQ_ASYNC_QUEUE_SIZE,
+                         BackPressureHandler handler = nullptr);
+
+    /*
+     * Number the messages of every table, call it before the first send.
+     *
+     * Each message then carries the random id of this client and a per
+     * table sequence number, so the server can tell when messages were
+     * dropped, see ZmqMessageHandler::handleSequenceGap(). Servers older
+     * than the numbering can't decode such messages.
+     */
+    void enableSequenceNumbers();
+
+    uint64_t getProducerId() const { return m_producerId; }
+
+    /*
+     * Compress messages of at least threshold bytes, call it before the
+     * first send. PUSH sockets have no handshake, so this is the client's
+     * choice: the flag in the message header tells the server, servers
+     * older than the flag can't decode such messages. Batches then may
+     * serialize to MQ_DECOMPRESSED_MAX_COUNT bytes, as long as they
+     * compress below MQ_RESPONSE_MAX_COUNT.
+     */
+    void enableCompression(size_t threshold = MQ_COMPRESS_THRESHOLD);
+
+    /*
+     * Serialize with the compact BinarySerializer::WIRE_VERSION_2 format,
+     * call it before the first send. Like compression this is the client's
+     * choice, servers older than the format can't decode such messages.
+     */
+    void enableCompactWireFormat();
+
+    /*
+     * Ask the server for an ack of every message, call it before the first
+     * send. The client then talks DEALER to a ZmqServer in ack mode. Up to
+     * maxInFlight messages wait for their ack, a send beyond that waits
+     * for the oldest ones first, so a producer keeps a window of batches
+     * in flight instead of a round trip per batch. Acks are read while
+     * sending and in waitForAcks(). Not for shm endpoints.
+     */
+    void enableAcks(size_t maxInFlight = MQ_ACK_MAX_IN_FLIGHT);
+
+    /*
+     * Wait until every sent message was acked, false on timeout. Throws
+     * when the server failed to handle a message since the last call.
+     */
+    bool waitForAcks(int timeoutMs = MQ_ACK_TIMEOUT_MS);
+
+    /* Messages sent and not acked yet */
+    size_t getInFlightCount();
+
+    /* Wait until every queued batch was sent, no-op in synchronous mode */
+    void flush();
+
+    /* Async queue metrics */
+    size_t getQueueDepth();
+    size_t getQueueHighWatermark();
+    uint64_t getBackPressureCount();
+
     bool isConnected();
 
     void connect();
 
+    // Serialize into a buffer from the client's pool, sized from the batch.
+    void sendMsg(const std::string& dbName,
+                 const std::string& tableName,
+                 const std::vector<KeyOpFieldsValuesTuple>& kcos);
+
+    // Serialize into the caller's buffer, it is grown when the batch doesn't fit.
     void sendMsg(const std::string& dbName,
                  const std::string& tableName,
                  const std::vector<KeyOpFieldsValuesTuple>& kcos,
                  std::vector<char>& sendbuffer);
+
+    // Number of idle buffers in the pool and the bytes they hold.
+    size_t getPooledBufferCount();
+    size_t getPooledBufferBytes();
 private:
+    struct AsyncMessage
+    {
+        std::string dbName;
+        std::string tableName;
+        std::vector<KeyOpFieldsValuesTuple> kcos;
+        size_t size;
+    };
+
     void initialize(const std::string& endpoint);
 
+    void serializeAndSend(const std::string& dbName,
+                          const std::string& tableName,
+                          const std::vector<KeyOpFieldsValuesTuple>& kcos,
+                          std::vector<char>& sendbuffer);
+
+    // add the message header when there is one, then send
+    void sendMessage(const std::string& dbName,
+                     const std::string& tableName,
+                     char* message,
+                     size_t length,
+                     uint64_t flags);
+
+    size_t getMessageHeaderSize() const;
+
+    // limit of a message before compression
+    size_t getMaxSerializedSize() const;
+
+    void enqueue(const std::string& dbName,
+                 const std::string& tableName,
+                 const std::vector<KeyOpFieldsValuesTuple>& kcos);
+
+    void flushThread();
+
+    void sendAsyncMessages(std::vector<AsyncMessage>& messages);
+
+    void checkAsyncError();
+
+    void stopAsyncSend();
+
+    void sendBuffer(const char* buffer, size_t length);
+
+    // shared memory transport, called with m_socketMutex held except sendShm()
+    void connectShm();
+
+    void disconnectShm();
+
+    bool shmPeerClosed();
+
+    void sendShm(const char* buffer, size_t length);
+
+    // ack mode, called with m_socketMutex held
+    bool receiveAcks(int timeoutMs);
+
+    void waitForAckWindow();
+
+    std::unique_ptr<std::vector<char>> acquireBuffer();
+
+    void releaseBuffer(std::unique_ptr<std::vector<char>> buffer);
+
 
     std::string m_endpoint;
 
@@ -36,6 +186,65 @@ private:
     bool m_connected;
 
     std::mutex m_socketMutex;
+
+    int m_shmSocket;
+
+    std::unique_ptr<ShmRing> m_shmRing;
+
+    // Send buffers shared by all producer tables of this client. Every
+    // sender takes one for the time of a send, so concurrent senders
+    // serialize in parallel and a single threaded client keeps one buffer.
+    std::vector<std::unique_ptr<std::vector<char>>> m_bufferPool;
+
+    std::mutex m_bufferPoolMutex;
+
+    std::unique_ptr<SelectableQueue<AsyncMessage>> m_asyncQueue;
+
+    std::shared_ptr<std::thread> m_flushThread;
+
+    SelectableEvent m_stopEvent;
+
+    BackPressureHandler m_backPressureHandler;
+
+    // queued plus in flight batches, flush() waits for 0
+    std::atomic<size_t> m_queueDepth;
+
+    std::atomic<size_t> m_queueHighWatermark;
+
+    std::atomic<uint64_t> m_backPressureCount;
+
+    std::mutex m_flushMutex;
+
+    std::condition_variable m_flushCv;
+
+    std::exception_ptr m_asyncError;
+
+    bool m_sequenceNumbers;
+
+    // 0 when compression is disabled
+    size_t m_compressThreshold;
+
+    uint8_t m_wireVersion;
+
+    uint64_t m_producerId;
+
+    // held from numbering a message until it was sent, so the numbers
+    // reach the server in order when several threads send
+    std::mutex m_sequenceMutex;
+
+    // db name + table name -> last sequence number
+    std::map<std::string, uint64_t> m_sequences;
+
+    bool m_ackMode;
+
+    size_t m_maxInFlight;
+
+    // the ack state is guarded by m_socketMutex, acks are read from the socket
+    uint64_t m_lastBatchId;
+
+    std::set<uint64_t> m_inFlight;
+
+    uint64_t m_failedBatchCount;
 };
 
 }
@@ -1,6 +1,7 @@
 #include <string>
 #include <deque>
 #include <limits>
+#include <inttypes.h>
 #include <hiredis/hiredis.h>
 #include <zmq.h>
 #include <pthread.h>
@@ -17,9 +18,13 @@ using namespace std;
 
 namespace swss {
 
-ZmqConsumerStateTable::ZmqConsumerStateTable(DBConnector *db, const std::string &tableName, ZmqServer &zmqServer, int popBatchSize, int pri, bool dbPersistence)
+ZmqConsumerStateTable::ZmqConsumerStateTable(DBConnector *db, const std::string &tableName, ZmqServer &zmqServer, int popBatchSize, int pri, bool dbPersistence, bool coalesce)
     : Selectable(pri)
     , TableBase(tableName, TableBase::getTableSeparator(db->getDbId()))
+    , m_coalesce(coalesce)
+    , m_resyncPending(false)
+    , m_resyncPosition(0)
+    , m_resyncCount(0)
     , m_db(db)
     , m_zmqServer(zmqServer)
 {
@@ -41,53 +46,218 @@ ZmqConsumerStateTable::ZmqConsumerStateTable(DBConnector *db, const std::string
 
 void ZmqConsumerStateTable::handleReceivedData(const std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> &kcos)
 {
-    for (auto kco : kcos)
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    entries.reserve(kcos.size());
+    for (auto& kco : kcos)
     {
-        std::shared_ptr<KeyOpFieldsValuesTuple> clone = nullptr;
-        if (m_asyncDBUpdater != nullptr)
+        entries.emplace_back(*kco);
+    }
+
+    handleReceivedEntries(entries);
+}
+
+void ZmqConsumerStateTable::handleReceivedEntries(std::vector<KeyOpFieldsValuesEntry> &entries)
+{
+    if (m_asyncDBUpdater != nullptr)
+    {
+        for (auto& entry : entries)
         {
-            // clone before put to received queue, because received data may change by consumer.
-            clone = std::make_shared<KeyOpFieldsValuesTuple>(*kco);
+            // async write need its own copy, because received data may change by consumer.
+            m_asyncDBUpdater->update(std::make_shared<KeyOpFieldsValuesTuple>(entry.toTuple()));
         }
+    }
 
+    {
+        std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
+        for (auto& entry : entries)
         {
-            std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
-            m_receivedOperationQueue.push(kco);
+            if (m_coalesce)
+            {
+                coalesceEntry(entry);
+            }
+            else
+            {
+                m_receivedOperationQueue.push_back(std::move(entry));
+            }
         }
+    }
 
-        if (m_asyncDBUpdater != nullptr)
+    m_selectableEvent.notify(); // will release epoll
+}
+
+void ZmqConsumerStateTable::coalesceEntry(KeyOpFieldsValuesEntry &entry)
+{
+    auto key = entry.getKey();
+    if (entry.getOp() == KeyOpFieldsValuesEntry::Op::OTHER)
+    {
+        // an operation that can't be merged gets a slot of its own, and
+        // ends the slot of its key, later updates start a new one after it
+        m_pendingKeys.emplace_back();
+        m_pendingKeys.back().set = true;
+        m_pendingKeys.back().entry = std::move(entry);
+        m_pendingKeyIndex.erase(key);
+        return;
+    }
+
+    auto result = m_pendingKeyIndex.emplace(key, m_pendingKeys.size());
+    if (result.second)
+    {
+        m_pendingKeys.emplace_back();
+    }
+
+    auto& pending = m_pendingKeys[result.first->second];
+    if (entry.getOp() == KeyOpFieldsValuesEntry::Op::DEL)
+    {
+        // keep the DEL for its key, a later SET replaces it
+        pending.del = true;
+        pending.set = false;
+        pending.entry = std::move(entry);
+    }
+    else if (pending.set)
+    {
+        mergeFields(pending.entry, entry);
+    }
+    else
+    {
+        // the first SET of the key
+        pending.set = true;
+        pending.entry = std::move(entry);
+    }
+}
+
+void ZmqConsumerStateTable::mergeFields(KeyOpFieldsValuesEntry &pending, const KeyOpFieldsValuesEntry &entry)
+{
+    // keep the field order of the pending SET, new fields go last
+    auto key = pending.getKey();
+    KeyOpFieldsValuesEntry merged(key, KeyOpFieldsValuesEntry::Op::SET);
+    std::vector<bool> updated(entry.getFieldCount(), false);
+    for (size_t i = 0; i < pending.getFieldCount(); i++)
+    {
+        auto field = pending.getField(i);
+        auto value = pending.getValue(i);
+        for (size_t j = 0; j < entry.getFieldCount(); j++)
         {
-            m_asyncDBUpdater->update(clone);
+            if (entry.getField(j) == field)
+            {
+                value = entry.getValue(j);
+                updated[j] = true;
+            }
         }
+
+        merged.addField(field, value);
     }
-    m_selectableEvent.notify(); // will release epoll
+
+    for (size_t j = 0; j < entry.getFieldCount(); j++)
+    {
+        if (!updated[j])
+        {
+            merged.addField(entry.getField(j), entry.getValue(j));
+        }
+    }
+
+    pending = std::move(merged);
+}
+
+void ZmqConsumerStateTable::handleSequenceGap(uint64_t producerId, uint64_t lostCount)
+{
+    SWSS_LOG_WARN("ZmqConsumerStateTable lost %" PRIu64 " messages from producer %" PRIx64 ", reload table: %s",
+                    lostCount, producerId, getTableName().c_str());
+
+    {
+        std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
+        if (!m_resyncPending)
+        {
+            m_resyncPending = true;
+            m_resyncPosition = m_coalesce ? m_pendingKeys.size() : m_receivedOperationQueue.size();
+        }
+
+        // updates after the gap must not merge into slots before the snapshot
+        m_pendingKeyIndex.clear();
+    }
+
+    m_selectableEvent.notify();
+}
+
+void ZmqConsumerStateTable::appendTableSnapshot(std::deque<KeyOpFieldsValuesTuple> &vkco)
+{
+    Table table(m_db, getTableName());
+    std::vector<std::string> keys;
+    table.scanKeys(keys);
+
+    std::vector<std::vector<FieldValueTuple>> values;
+    std::vector<bool> exists;
+    table.getEntries(keys, values, exists);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        // deleted since the scan
+        if (exists[i])
+        {
+            vkco.emplace_back(keys[i], SET_COMMAND, std::move(values[i]));
+        }
+    }
+
+    m_resyncCount++;
+    SWSS_LOG_NOTICE("ZmqConsumerStateTable reloaded %zu keys of table: %s", keys.size(), getTableName().c_str());
 }
 
 /* Get multiple pop elements */
 void ZmqConsumerStateTable::pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const std::string& /*prefix*/)
 {
-    size_t count;
+    std::deque<KeyOpFieldsValuesEntry> entries;
+    std::deque<PendingKey> pendingKeys;
+    bool resync;
+    size_t resyncPosition;
     {
-        // size() is not thread safe
+        // For new data append to m_receivedOperationQueue during pops, will not be include in result.
         std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
-
-        // For new data append to m_dataQueue during pops, will not be include in result.
-        count = m_receivedOperationQueue.size();
-        if (!count)
+        if (m_receivedOperationQueue.empty() && m_pendingKeys.empty() && !m_resyncPending)
         {
             return;
         }
+
+        entries.swap(m_receivedOperationQueue);
+        pendingKeys.swap(m_pendingKeys);
+        m_pendingKeyIndex.clear();
+        resync = m_resyncPending;
+        resyncPosition = m_resyncPosition;
+        m_resyncPending = false;
     }
 
     vkco.clear();
-    for (size_t ie = 0; ie < count; ie++)
+    size_t count = m_coalesce ? pendingKeys.size() : entries.size();
+    for (size_t i = 0; i <= count; i++)
     {
-        auto& kco = *(m_receivedOperationQueue.front());
-        vkco.push_back(std::move(kco));
+        // The persisted table may lag behind the received updates, so the
+        // snapshot goes where the gap was detected: the updates received
+        // after the gap override it.
+        if (resync && i == resyncPosition)
+        {
+            appendTableSnapshot(vkco);
+        }
+
+        if (i == count)
+        {
+            break;
+        }
+
+        if (!m_coalesce)
+        {
+            vkco.emplace_back();
+            entries[i].toTuple(vkco.back());
+            continue;
+        }
+
+        auto& pending = pendingKeys[i];
+        if (pending.del)
+        {
+            vkco.emplace_back(pending.entry.getKey(), DEL_COMMAND, std::vector<FieldValueTuple>{});
+        }
 
+        if (pending.set)
         {
-            std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
-            m_receivedOperationQueue.pop();
+            vkco.emplace_back();
+            pending.entry.toTuple(vkco.back());
         }
     }
 }
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <deque>
+#include <unordered_map>
 #include <condition_variable>
 #include "asyncdbupdater.h"
 #include "consumertablebase.h"
 #include "dbconnector.h"
+#include "keyopfieldsvaluesentry.h"
 #include "selectableevent.h"
 #include "table.h"
 #include "zmqserver.h"
@@ -18,7 +21,16 @@ public:
     /* The default value of pop batch size is 128 */
     static constexpr int DEFAULT_POP_BATCH_SIZE = 128;
 
-    ZmqConsumerStateTable(DBConnector *db, const std::string &tableName, ZmqServer &zmqServer, int popBatchSize = DEFAULT_POP_BATCH_SIZE, int pri = 0, bool dbPersistence = false);
+    /*
+     * With coalesce the received updates are kept per key, ordered by the
+     * first arrival of the key, like ConsumerStateTable does with its key
+     * set: a SET merges its fields into the pending SET, a DEL drops the
+     * pending SET, and pops() returns at most a DEL followed by a SET for
+     * each key. A backlogged consumer then only sees the latest state.
+     * Other operations are never merged, they keep their order with the
+     * updates of their key before and after them.
+     */
+    ZmqConsumerStateTable(DBConnector *db, const std::string &tableName, ZmqServer &zmqServer, int popBatchSize = DEFAULT_POP_BATCH_SIZE, int pri = 0, bool dbPersistence = false, bool coalesce = false);
 
     /* Get multiple pop elements */
     void pops(std::deque<KeyOpFieldsValuesTuple> &vkco, const std::string &prefix = EMPTY_PREFIX);
@@ -46,7 +58,7 @@ public:
     bool hasData() override
     {
         std::lock_guard<std::mutex> lock(m_receivedQueueMutex);
-        return !m_receivedOperationQueue.empty();
+        return !m_receivedOperationQueue.empty() || !m_pendingKeys.empty() || m_resyncPending;
     }
 
     /* true if Selectable has data in its cache */
@@ -55,10 +67,14 @@ public:
         return hasData();
     }
 
-    /* true if Selectable was initialized with data */
+    /*
+     * true if Selectable was initialized with data. The table isn't loaded
+     * from the DB at construction: when updates of numbered producers were
+     * lost before the consumer started, the first message received reports
+     * the gap and pops() reloads the table then, see handleSequenceGap().
+     */
     bool initializedWithData() override
     {
-        // TODO, if we need load data from redis during initialize, don't forget change code here.
         return false;
     }
 
@@ -69,12 +85,57 @@ public:
 
     size_t dbUpdaterQueueSize();
 
+    /* Number of times the table was reloaded after lost messages */
+    uint64_t getResyncCount() const
+    {
+        return m_resyncCount;
+    }
+
 private:
-    void handleReceivedData(const std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> &kcos);
+    void handleReceivedData(const std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> &kcos) override;
+
+    void handleReceivedEntries(std::vector<KeyOpFieldsValuesEntry> &entries) override;
+
+    /*
+     * The lost entries are unknown, the next pops() returns a SET for every
+     * key of the table in the DB at the position of the gap: after the
+     * entries received before it, before the ones received after it, which
+     * may be newer than the DB. The DB has the lost entries when the
+     * producer writes the table, see ZmqProducerStateTable dbPersistence.
+     */
+    void handleSequenceGap(uint64_t producerId, uint64_t lostCount) override;
+
+    void appendTableSnapshot(std::deque<KeyOpFieldsValuesTuple> &vkco);
+
+    struct PendingKey
+    {
+        bool del = false;
+        bool set = false;
+        KeyOpFieldsValuesEntry entry; // the merged SET or other op, or the DEL when set is false
+    };
+
+    // called with m_receivedQueueMutex held
+    void coalesceEntry(KeyOpFieldsValuesEntry &entry);
+
+    static void mergeFields(KeyOpFieldsValuesEntry &pending, const KeyOpFieldsValuesEntry &entry);
 
     std::mutex m_receivedQueueMutex;
 
-    std::queue<std::shared_ptr<KeyOpFieldsValuesTuple>> m_receivedOperationQueue;
+    std::deque<KeyOpFieldsValuesEntry> m_receivedOperationQueue;
+
+    bool m_coalesce;
+
+    // pending keys in the order of first arrival, used with coalesce
+    std::deque<PendingKey> m_pendingKeys;
+
+    std::unordered_map<std::string, size_t> m_pendingKeyIndex;
+
+    bool m_resyncPending;
+
+    // queue or slot index of the first gap since the last pops()
+    size_t m_resyncPosition;
+
+    std::atomic<uint64_t> m_resyncCount;
 
     swss::SelectableEvent m_selectableEvent;
 
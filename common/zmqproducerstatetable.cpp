@@ -36,10 +36,19 @@ ZmqProducerStateTable::ZmqProducerStateTable(RedisPipeline *pipeline, const stri
     initialize(pipeline->getDBConnector(), tableName, dbPersistence);
 }
 
+ZmqProducerStateTable::~ZmqProducerStateTable()
+{
+    stopBatching();
+}
+
 void ZmqProducerStateTable::initialize(DBConnector *db, const std::string &tableName, bool dbPersistence)
 {
-    m_sendbuffer.resize(MQ_RESPONSE_MAX_COUNT);
-    
+    m_batchMaxEntries = 0;
+    m_batchMaxBytes = 0;
+    m_pendingCount = 0;
+    m_pendingBytes = 0;
+    m_stopLinger = false;
+
     if (dbPersistence)
     {
         SWSS_LOG_DEBUG("Database persistence enabled, tableName: %s", tableName.c_str());
@@ -61,11 +70,7 @@ void ZmqProducerStateTable::set(
     std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
         KeyOpFieldsValuesTuple{key, op, values}
     };
-    m_zmqClient.sendMsg(
-                        m_dbName,
-                        m_tableNameStr,
-                        kcos,
-                        m_sendbuffer);
+    sendOrBatch(kcos);
 
     if (m_asyncDBUpdater != nullptr)
     {
@@ -90,11 +95,7 @@ void ZmqProducerStateTable::del(
     std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
         KeyOpFieldsValuesTuple{key, op, std::vector<FieldValueTuple>{}}
     };
-    m_zmqClient.sendMsg(
-                        m_dbName,
-                        m_tableNameStr,
-                        kcos,
-                        m_sendbuffer);
+    sendOrBatch(kcos);
 
     if (m_asyncDBUpdater != nullptr)
     {
@@ -109,11 +110,7 @@ void ZmqProducerStateTable::del(
 
 void ZmqProducerStateTable::set(const std::vector<KeyOpFieldsValuesTuple> &values)
 {
-    m_zmqClient.sendMsg(
-                        m_dbName,
-                        m_tableNameStr,
-                        values,
-                        m_sendbuffer);
+    sendOrBatch(values);
     
     if (m_asyncDBUpdater != nullptr)
     {
@@ -133,11 +130,7 @@ void ZmqProducerStateTable::del(const std::vector<std::string> &keys)
     {
         kcos.push_back(KeyOpFieldsValuesTuple{key, DEL_COMMAND, std::vector<FieldValueTuple>{}});
     }
-    m_zmqClient.sendMsg(
-                        m_dbName,
-                        m_tableNameStr,
-                        kcos,
-                        m_sendbuffer);
+    sendOrBatch(kcos);
     
     if (m_asyncDBUpdater != nullptr)
     {
@@ -154,11 +147,7 @@ void ZmqProducerStateTable::del(const std::vector<std::string> &keys)
 
 void ZmqProducerStateTable::send(const std::vector<KeyOpFieldsValuesTuple> &kcos)
 {
-    m_zmqClient.sendMsg(
-                        m_dbName,
-                        m_tableNameStr,
-                        kcos,
-                        m_sendbuffer);
+    sendOrBatch(kcos);
     
     if (m_asyncDBUpdater != nullptr)
     {
@@ -171,6 +160,288 @@ void ZmqProducerStateTable::send(const std::vector<KeyOpFieldsValuesTuple> &kcos
     }
 }
 
+void ZmqProducerStateTable::setBatching(size_t maxEntries, size_t maxBytes, unsigned int lingerUsec)
+{
+    stopBatching();
+
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+        m_batchMaxEntries = maxEntries;
+        m_batchMaxBytes = maxBytes;
+        m_batchLinger = std::chrono::microseconds(lingerUsec);
+    }
+
+    if (maxEntries > 0)
+    {
+        m_stopLinger = false;
+        m_lingerThread = std::make_shared<std::thread>(&ZmqProducerStateTable::lingerThread, this);
+    }
+}
+
+void ZmqProducerStateTable::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_batchMutex);
+        sendPending(lock);
+    }
+
+    checkBatchError();
+
+    ProducerStateTable::flush();
+}
+
+bool ZmqProducerStateTable::waitForAcks(int timeoutMs)
+{
+    flush();
+
+    return m_zmqClient.waitForAcks(timeoutMs);
+}
+
+size_t ZmqProducerStateTable::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_batchMutex);
+    return m_pendingCount;
+}
+
+void ZmqProducerStateTable::sendOrBatch(const std::vector<KeyOpFieldsValuesTuple> &kcos)
+{
+    checkBatchError();
+
+    std::unique_lock<std::mutex> lock(m_batchMutex);
+    if (m_batchMaxEntries == 0)
+    {
+        std::lock_guard<std::mutex> sendLock(m_sendMutex);
+        lock.unlock();
+
+        m_zmqClient.sendMsg(
+                            m_dbName,
+                            m_tableNameStr,
+                            kcos);
+        return;
+    }
+
+    if (m_pendingCount == 0)
+    {
+        m_batchDeadline = std::chrono::steady_clock::now() + m_batchLinger;
+        m_batchCv.notify_all();
+    }
+
+    for (auto &kco : kcos)
+    {
+        addPending(kco);
+    }
+
+    if (m_pendingCount >= m_batchMaxEntries || m_pendingBytes >= m_batchMaxBytes)
+    {
+        sendPending(lock);
+    }
+}
+
+size_t ZmqProducerStateTable::getEntryBytes(const KeyOpFieldsValuesTuple &kco)
+{
+    size_t bytes = kfvKey(kco).length() + kfvOp(kco).length();
+    for (auto &fv : kfvFieldsValues(kco))
+    {
+        bytes += fvField(fv).length() + fvValue(fv).length();
+    }
+
+    return bytes;
+}
+
+void ZmqProducerStateTable::addPending(const KeyOpFieldsValuesTuple &kco)
+{
+    auto &key = kfvKey(kco);
+    auto &op = kfvOp(kco);
+
+    auto &pendingKey = m_pendingKeys[key];
+    long index = (long)m_pending.size();
+
+    if (op == SET_COMMAND && pendingKey.set >= 0)
+    {
+        // merge the fields into the pending SET in place, like hset on the
+        // table, so the key keeps its position before the updates that
+        // followed its first SET
+        auto &fvs = kfvFieldsValues(m_pending[pendingKey.set]);
+        for (auto &fv : kfvFieldsValues(kco))
+        {
+            auto it = std::find_if(fvs.begin(), fvs.end(),
+                    [&fv](const FieldValueTuple &pending) { return fvField(pending) == fvField(fv); });
+            if (it == fvs.end())
+            {
+                m_pendingBytes += fvField(fv).length() + fvValue(fv).length();
+                fvs.push_back(fv);
+            }
+            else
+            {
+                m_pendingBytes += fvValue(fv).length();
+                m_pendingBytes -= fvValue(*it).length();
+                fvValue(*it) = fvValue(fv);
+            }
+        }
+
+        return;
+    }
+
+    m_pending.push_back(kco);
+    m_pendingDropped.push_back(false);
+    m_pendingCount++;
+    m_pendingBytes += getEntryBytes(kco);
+
+    if (op == SET_COMMAND)
+    {
+        pendingKey.set = index;
+    }
+    else if (op == DEL_COMMAND)
+    {
+        // the DEL makes everything pending for the key obsolete
+        dropPending(pendingKey.set);
+        dropPending(pendingKey.del);
+        pendingKey.del = index;
+        pendingKey.set = -1;
+    }
+    else
+    {
+        // other operations are sent as they are and nothing merges across them
+        pendingKey.del = -1;
+        pendingKey.set = -1;
+    }
+}
+
+void ZmqProducerStateTable::dropPending(long index)
+{
+    if (index < 0 || m_pendingDropped[index])
+    {
+        return;
+    }
+
+    m_pendingDropped[index] = true;
+    m_pendingCount--;
+    m_pendingBytes -= getEntryBytes(m_pending[index]);
+}
+
+void ZmqProducerStateTable::sendPending(std::unique_lock<std::mutex> &lock)
+{
+    if (m_pendingCount == 0)
+    {
+        return;
+    }
+
+    std::vector<KeyOpFieldsValuesTuple> kcos;
+    kcos.reserve(m_pendingCount);
+    for (size_t i = 0; i < m_pending.size(); i++)
+    {
+        if (!m_pendingDropped[i])
+        {
+            kcos.push_back(std::move(m_pending[i]));
+        }
+    }
+
+    m_pending.clear();
+    m_pendingDropped.clear();
+    m_pendingKeys.clear();
+    m_pendingCount = 0;
+    m_pendingBytes = 0;
+
+    // Take the send lock before the batch lock is released, so batches
+    // leave in the order they were taken, while updates keep batching
+    // during a slow send.
+    std::unique_lock<std::mutex> sendLock(m_sendMutex);
+    lock.unlock();
+
+    try
+    {
+        m_zmqClient.sendMsg(
+                            m_dbName,
+                            m_tableNameStr,
+                            kcos);
+    }
+    catch (...)
+    {
+        sendLock.unlock();
+        lock.lock();
+        throw;
+    }
+
+    sendLock.unlock();
+    lock.lock();
+}
+
+void ZmqProducerStateTable::lingerThread()
+{
+    SWSS_LOG_ENTER();
+
+    std::unique_lock<std::mutex> lock(m_batchMutex);
+    while (!m_stopLinger)
+    {
+        if (m_pendingCount == 0)
+        {
+            m_batchCv.wait(lock);
+            continue;
+        }
+
+        if (m_batchCv.wait_until(lock, m_batchDeadline) != std::cv_status::timeout)
+        {
+            continue;
+        }
+
+        if (m_pendingCount > 0 && std::chrono::steady_clock::now() >= m_batchDeadline)
+        {
+            try
+            {
+                sendPending(lock);
+            }
+            catch (...)
+            {
+                m_batchError = std::current_exception();
+            }
+        }
+    }
+}
+
+void ZmqProducerStateTable::checkBatchError()
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+        error = m_batchError;
+        m_batchError = nullptr;
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ZmqProducerStateTable::stopBatching()
+{
+    if (!m_lingerThread)
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_batchMutex);
+        m_stopLinger = true;
+
+        try
+        {
+            sendPending(lock);
+        }
+        catch (const std::exception &e)
+        {
+            SWSS_LOG_ERROR("Failed to send pending batch of table %s: %s", m_tableNameStr.c_str(), e.what());
+        }
+    }
+
+    m_batchCv.notify_all();
+    m_lingerThread->join();
+    m_lingerThread = nullptr;
+
+    std::lock_guard<std::mutex> lock(m_batchMutex);
+    m_batchMaxEntries = 0;
+}
+
 size_t ZmqProducerStateTable::dbUpdaterQueueSize()
 {
     if (m_asyncDBUpdater == nullptr)
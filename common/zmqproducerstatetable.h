@@ -5,6 +5,10 @@
 #include <queue>
 #include <thread> 
 #include <mutex> 
+#include <chrono>
+#include <exception>
+#include <unordered_map>
+#include <condition_variable>
 #include "asyncdbupdater.h"
 #include "producerstatetable.h"
 #include "redispipeline.h"
@@ -18,6 +22,34 @@ class ZmqProducerStateTable : public ProducerStateTable
 public:
     ZmqProducerStateTable(DBConnector *db, const std::string &tableName, ZmqClient &zmqClient, bool dbPersistence = true);
     ZmqProducerStateTable(RedisPipeline *pipeline, const std::string &tableName, ZmqClient &zmqClient, bool buffered = false, bool dbPersistence = true);
+    virtual ~ZmqProducerStateTable();
+
+    /*
+     * Accumulate updates and send them as one message, maxEntries 0 sends
+     * every update right away (the default).
+     *
+     * A SET of a pending key merges its fields into the pending SET, which
+     * keeps its position, like the coalescing of ZmqConsumerStateTable, so
+     * updates of other keys that refer to it stay after it. A DEL replaces
+     * everything pending for the key, a SET after a pending DEL is kept
+     * after it. The batch is sent when it holds maxEntries updates or about
+     * maxBytes of live updates, or lingerUsec after its first update,
+     * whichever comes first. A send error of the background flush
+     * is thrown from the next update or flush().
+     */
+    void setBatching(size_t maxEntries,
+                     size_t maxBytes = MQ_BATCH_MAX_BYTES,
+                     unsigned int lingerUsec = MQ_BATCH_LINGER_USEC);
+
+    /* Send the pending batch now, then flush the redis pipeline */
+    void flush();
+
+    /*
+     * Flush, then wait until the server handled every batch sent by the
+     * client, which needs ZmqClient::enableAcks(). The client is shared,
+     * so this covers the batches of its other tables too.
+     */
+    bool waitForAcks(int timeoutMs = MQ_ACK_TIMEOUT_MS);
 
     /* Implements set() and del() commands using notification messages */
     virtual void set(const std::string &key,
@@ -38,12 +70,71 @@ public:
     virtual void send(const std::vector<KeyOpFieldsValuesTuple> &kcos);
 
     size_t dbUpdaterQueueSize();
+
+    /* Number of updates waiting in the batch */
+    size_t getPendingCount();
 private:
+    // indexes in m_pending of the pending updates of a key, -1 when none
+    struct PendingKey
+    {
+        long del = -1;
+        long set = -1;
+    };
+
     void initialize(DBConnector *db, const std::string &tableName, bool dbPersistence);
 
+    void sendOrBatch(const std::vector<KeyOpFieldsValuesTuple> &kcos);
+
+    void addPending(const KeyOpFieldsValuesTuple &kco);
+
+    void dropPending(long index);
+
+    static size_t getEntryBytes(const KeyOpFieldsValuesTuple &kco);
+
+    // called with m_batchMutex held, released while the batch is sent
+    void sendPending(std::unique_lock<std::mutex> &lock);
+
+    void lingerThread();
+
+    void checkBatchError();
+
+    void stopBatching();
+
     ZmqClient& m_zmqClient;
-    
-    std::vector<char> m_sendbuffer;
+
+    size_t m_batchMaxEntries;
+
+    size_t m_batchMaxBytes;
+
+    std::chrono::microseconds m_batchLinger;
+
+    // guards the batching settings and the pending batch
+    std::mutex m_batchMutex;
+
+    // held while a message is sent, taken before m_batchMutex is released
+    std::mutex m_sendMutex;
+
+    std::condition_variable m_batchCv;
+
+    // pending updates in send order, replaced ones are marked dropped
+    std::vector<KeyOpFieldsValuesTuple> m_pending;
+
+    std::vector<bool> m_pendingDropped;
+
+    std::unordered_map<std::string, PendingKey> m_pendingKeys;
+
+    size_t m_pendingCount;
+
+    // size of the pending updates that are not dropped
+    size_t m_pendingBytes;
+
+    std::chrono::steady_clock::time_point m_batchDeadline;
+
+    bool m_stopLinger;
+
+    std::shared_ptr<std::thread> m_lingerThread;
+
+    std::exception_ptr m_batchError;
 
     const std::string m_dbName;
     const std::string m_tableNameStr;
@@ -1,30 +1,117 @@
 #include <string>
 #include <deque>
 #include <limits>
+#include <mutex>
 #include <hiredis/hiredis.h>
 #include <zmq.h>
 #include <pthread.h>
+#include <poll.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/socket.h>
 #include "zmqserver.h"
+#include "shmring.h"
 #include "binaryserializer.h"
 
 using namespace std;
 
 namespace swss {
 
-ZmqServer::ZmqServer(const std::string& endpoint)
+// A received message waiting for its decode thread, owns the zmq payload.
+struct ZmqReceivedMessage
+{
+    ZmqReceivedMessage(size_t id, zmq_msg_t& msg, const std::string& client, uint64_t batchId)
+        : handlerId(id)
+        , identity(client)
+        , ackId(batchId)
+    {
+        zmq_msg_init(&message);
+        zmq_msg_move(&message, &msg);
+    }
+
+    ~ZmqReceivedMessage()
+    {
+        zmq_msg_close(&message);
+    }
+
+    size_t handlerId;
+    zmq_msg_t message;
+
+    // the client to ack, empty when it wants none
+    std::string identity;
+    uint64_t ackId;
+};
+
+struct ZmqServer::DecodeWorker
+{
+    std::shared_ptr<std::thread> thread;
+
+    std::mutex queueMutex;
+
+    std::condition_variable queueCv;
+
+    std::deque<std::unique_ptr<ZmqReceivedMessage>> queue;
+
+    bool stop = false;
+};
+
+ZmqServer::ZmqServer(const std::string& endpoint, size_t decodeThreadCount, bool ackMode)
     : m_endpoint(endpoint)
+    , m_ackMode(ackMode)
 {
-    m_buffer.resize(MQ_RESPONSE_MAX_COUNT);
+    if (ackMode && ShmRing::isShmEndpoint(endpoint))
+    {
+        SWSS_LOG_THROW("ZmqServer acks are not supported on shm endpoint: %s", endpoint.c_str());
+    }
+
     m_runThread = true;
+
+    for (size_t i = 0; i < decodeThreadCount; i++)
+    {
+        m_decodeWorkers.push_back(std::unique_ptr<DecodeWorker>(new DecodeWorker()));
+    }
+
+    for (auto& worker : m_decodeWorkers)
+    {
+        worker->thread = std::make_shared<std::thread>(&ZmqServer::decodeThread, this, worker.get());
+    }
+
     m_mqPollThread = std::make_shared<std::thread>(&ZmqServer::mqPollThread, this);
 
-    SWSS_LOG_DEBUG("ZmqServer ctor endpoint: %s", endpoint.c_str());
+    SWSS_LOG_DEBUG("ZmqServer ctor endpoint: %s, decode threads: %zu, ack mode: %d", endpoint.c_str(), decodeThreadCount, ackMode);
 }
 
 ZmqServer::~ZmqServer()
 {
     m_runThread = false;
+
+    // the poll thread may wait for room in a decode queue
+    for (auto& worker : m_decodeWorkers)
+    {
+        std::lock_guard<std::mutex> lock(worker->queueMutex);
+        worker->queueCv.notify_all();
+    }
+
     m_mqPollThread->join();
+
+    stopDecodeThreads();
+}
+
+void ZmqServer::stopDecodeThreads()
+{
+    for (auto& worker : m_decodeWorkers)
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker->queueMutex);
+            worker->stop = true;
+        }
+
+        worker->queueCv.notify_all();
+        worker->thread->join();
+    }
+
+    m_decodeWorkers.clear();
 }
 
 void ZmqServer::registerMessageHandler(
@@ -32,13 +119,18 @@ void ZmqServer::registerMessageHandler(
                                     const std::string tableName,
                                     ZmqMessageHandler* handler)
 {
-    auto dbResult = m_HandlerMap.insert(pair<string, map<string, ZmqMessageHandler*>>(dbName, map<string, ZmqMessageHandler*>()));
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+
+    auto dbResult = m_HandlerMap.insert(pair<string, map<string, size_t>>(dbName, map<string, size_t>()));
     if (dbResult.second) {
         SWSS_LOG_DEBUG("ZmqServer add handler mapping for db: %s", dbName.c_str());
     }
 
-    auto tableResult = dbResult.first->second.insert(pair<string, ZmqMessageHandler*>(tableName, handler));
+    auto tableResult = dbResult.first->second.insert(pair<string, size_t>(tableName, m_handlers.size()));
     if (tableResult.second) {
+        std::unique_ptr<HandlerState> state(new HandlerState());
+        state->handler = handler;
+        m_handlers.push_back(std::move(state));
         SWSS_LOG_DEBUG("ZmqServer register handler for db: %s, table: %s", dbName.c_str(), tableName.c_str());
     }
 }
@@ -47,51 +139,250 @@ ZmqMessageHandler* ZmqServer::findMessageHandler(
                                                 const std::string dbName,
                                                 const std::string tableName)
 {
+    int id = findMessageHandlerId(dbName, tableName);
+    if (id < 0) {
+        return nullptr;
+    }
+
+    return getHandlerState((size_t)id).handler;
+}
+
+ZmqServer::HandlerState& ZmqServer::getHandlerState(size_t handlerId)
+{
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+
+    // the state itself doesn't move when m_handlers grows
+    return *m_handlers[handlerId];
+}
+
+int ZmqServer::findMessageHandlerId(
+                                    const std::string& dbName,
+                                    const std::string& tableName)
+{
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+
     auto dbMappingIter = m_HandlerMap.find(dbName);
     if (dbMappingIter == m_HandlerMap.end()) {
         SWSS_LOG_DEBUG("ZmqServer can't find any handler for db: %s", dbName.c_str());
-        return nullptr;
+        return -1;
     }
 
     auto tableMappingIter = dbMappingIter->second.find(tableName);
     if (tableMappingIter == dbMappingIter->second.end()) {
         SWSS_LOG_DEBUG("ZmqServer can't find handler for db: %s, table: %s", dbName.c_str(), tableName.c_str());
-        return nullptr;
+        return -1;
     }
 
-    return tableMappingIter->second;
+    return (int)tableMappingIter->second;
 }
 
-void ZmqServer::handleReceivedData(const char* buffer, const size_t size)
+bool ZmqServer::handleReceivedData(const char* buffer, const size_t size)
 {
+    BinarySerializer::MessageHeader header;
+    size_t offset = BinarySerializer::deserializeMessageHeader(buffer, size, header);
+
     std::string dbName;
     std::string tableName;
-    std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> kcos;
-    BinarySerializer::deserializeBuffer(buffer, size, dbName, tableName, kcos);
+    BinarySerializer::deserializeHeader(buffer + offset, size - offset, dbName, tableName);
 
     // find handler
-    auto handler = findMessageHandler(dbName, tableName);
-    if (handler == nullptr) {
-        SWSS_LOG_WARN("ZmqServer can't find handler for received message: %s", buffer);
+    int id = findMessageHandlerId(dbName, tableName);
+    if (id < 0) {
+        SWSS_LOG_WARN("ZmqServer can't find handler for received message, db: %s, table: %s", dbName.c_str(), tableName.c_str());
+        return false;
+    }
+
+    handleReceivedData((size_t)id, buffer, size);
+    return true;
+}
+
+void ZmqServer::handleReceivedData(size_t handlerId, const char* buffer, const size_t size)
+{
+    BinarySerializer::MessageHeader header;
+    size_t offset = BinarySerializer::deserializeMessageHeader(buffer, size, header);
+
+    const char* body = buffer + offset;
+    size_t bodySize = size - offset;
+    std::vector<char> decompressed;
+    if (header.flags & BinarySerializer::FLAG_COMPRESSED)
+    {
+        BinarySerializer::decompressBody(body, bodySize, MQ_DECOMPRESSED_MAX_COUNT, decompressed);
+        body = decompressed.data();
+        bodySize = decompressed.size();
+    }
+
+    std::string dbName;
+    std::string tableName;
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    BinarySerializer::deserializeBuffer(body, bodySize, dbName, tableName, entries);
+
+    auto& state = getHandlerState(handlerId);
+    if (header.flags & BinarySerializer::FLAG_SEQUENCE)
+    {
+        checkSequence(state, header.producerId, header.sequence);
+    }
+
+    state.handler->handleReceivedEntries(entries);
+}
+
+void ZmqServer::checkSequence(HandlerState& state, uint64_t producerId, uint64_t sequence)
+{
+    state.messageCount++;
+
+    // Producers number from 1, a first message with a higher number means
+    // the messages before it were lost, e.g. the ones sent before a restart.
+    auto it = state.producers.find(producerId);
+    if (it == state.producers.end())
+    {
+        if (state.producers.size() >= MQ_SEQUENCE_MAX_PRODUCERS)
+        {
+            dropStaleProducer(state);
+        }
+
+        it = state.producers.emplace(producerId, ProducerSequence{1, 0}).first;
+    }
+
+    auto& producer = it->second;
+    producer.lastMessage = state.messageCount;
+
+    uint64_t expected = producer.nextSequence;
+    if (sequence < expected)
+    {
+        SWSS_LOG_WARN("ZmqServer received old message from producer %" PRIx64 ", sequence: %" PRIu64 ", expected: %" PRIu64,
+                        producerId, sequence, expected);
+        return;
+    }
+
+    producer.nextSequence = sequence + 1;
+    if (sequence > expected)
+    {
+        SWSS_LOG_WARN("ZmqServer lost %" PRIu64 " messages from producer %" PRIx64 ", endpoint: %s",
+                        sequence - expected, producerId, m_endpoint.c_str());
+        state.handler->handleSequenceGap(producerId, sequence - expected);
+    }
+}
+
+void ZmqServer::dropStaleProducer(HandlerState& state)
+{
+    // a restarted producer comes back with a new id, the old one stays silent
+    auto stale = state.producers.begin();
+    for (auto it = state.producers.begin(); it != state.producers.end(); it++)
+    {
+        if (it->second.lastMessage < stale->second.lastMessage)
+        {
+            stale = it;
+        }
+    }
+
+    SWSS_LOG_NOTICE("ZmqServer drops sequence of producer %" PRIx64 ", endpoint: %s", stale->first, m_endpoint.c_str());
+    state.producers.erase(stale);
+}
+
+void ZmqServer::decodeThread(DecodeWorker* worker)
+{
+    SWSS_LOG_ENTER();
+
+    std::unique_ptr<ZmqReceivedMessage> received;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(worker->queueMutex);
+            worker->queueCv.wait(lock, [worker]() { return worker->stop || !worker->queue.empty(); });
+
+            // handlers may be gone when the server is destroyed, drop the rest
+            if (worker->stop)
+            {
+                break;
+            }
+
+            received = std::move(worker->queue.front());
+            worker->queue.pop_front();
+        }
+
+        // the poll thread may wait for room
+        worker->queueCv.notify_all();
+
+        uint64_t status = MQ_ACK_OK;
+        try
+        {
+            handleReceivedData(
+                            received->handlerId,
+                            static_cast<const char*>(zmq_msg_data(&received->message)),
+                            zmq_msg_size(&received->message));
+        }
+        catch (const std::exception& e)
+        {
+            SWSS_LOG_ERROR("ZmqServer failed to handle message, endpoint: %s, error: %s", m_endpoint.c_str(), e.what());
+            status = MQ_ACK_FAILED;
+        }
+
+        if (!received->identity.empty())
+        {
+            queueAck(received->identity, received->ackId, status);
+        }
+
+        received.reset();
+    }
+}
+
+void ZmqServer::dispatchToDecodeThread(zmq_msg_t& message, const std::string& identity, uint64_t ackId)
+{
+    auto buffer = static_cast<const char*>(zmq_msg_data(&message));
+    auto size = zmq_msg_size(&message);
+
+    BinarySerializer::MessageHeader header;
+    size_t offset = BinarySerializer::deserializeMessageHeader(buffer, size, header);
+
+    std::string dbName;
+    std::string tableName;
+    BinarySerializer::deserializeHeader(buffer + offset, size - offset, dbName, tableName);
+
+    int id = findMessageHandlerId(dbName, tableName);
+    if (id < 0) {
+        SWSS_LOG_WARN("ZmqServer can't find handler for received message, db: %s, table: %s", dbName.c_str(), tableName.c_str());
+        if (!identity.empty())
+        {
+            queueAck(identity, ackId, MQ_ACK_FAILED);
+        }
+
         return;
     }
 
-    handler->handleReceivedData(kcos);
+    // one thread per table keeps the order of its messages
+    auto& worker = m_decodeWorkers[(size_t)id % m_decodeWorkers.size()];
+    std::unique_ptr<ZmqReceivedMessage> received(new ZmqReceivedMessage((size_t)id, message, identity, ackId));
+
+    std::unique_lock<std::mutex> lock(worker->queueMutex);
+    worker->queueCv.wait(lock, [this, &worker]() { return !m_runThread || worker->queue.size() < MQ_WATERMARK; });
+    worker->queue.push_back(std::move(received));
+    worker->queueCv.notify_all();
 }
 
 void ZmqServer::mqPollThread()
 {
     SWSS_LOG_ENTER();
+
+    if (ShmRing::isShmEndpoint(m_endpoint))
+    {
+        shmPollThread();
+        return;
+    }
+
     SWSS_LOG_NOTICE("mqPollThread begin");
 
     // Producer/Consumer state table are n:1 mapping, so need use PUSH/PULL pattern http://api.zeromq.org/master:zmq-socket
+    // Clients that want acks use DEALER/ROUTER, the ROUTER socket knows which client sent a message.
     void* context = zmq_ctx_new();;
-    void* socket = zmq_socket(context, ZMQ_PULL);
+    void* socket = zmq_socket(context, m_ackMode ? ZMQ_ROUTER : ZMQ_PULL);
 
     // Increase recv buffer for use all bandwidth:  http://api.zeromq.org/4-2:zmq-setsockopt
     int high_watermark = MQ_WATERMARK;
     zmq_setsockopt(socket, ZMQ_RCVHWM, &high_watermark, sizeof(high_watermark));
 
+    // Messages are received into buffers owned by zmq, keep the size limit on the socket.
+    int64_t max_message_size = MQ_RESPONSE_MAX_COUNT;
+    zmq_setsockopt(socket, ZMQ_MAXMSGSIZE, &max_message_size, sizeof(max_message_size));
+
     int rc = zmq_bind(socket, m_endpoint.c_str());
     if (rc != 0)
     {
@@ -101,17 +392,32 @@ void ZmqServer::mqPollThread()
     }
 
     // zmq_poll will use less CPU
-    zmq_pollitem_t poll_item;
-    poll_item.fd = 0;
-    poll_item.socket = socket;
-    poll_item.events = ZMQ_POLLIN;
-    poll_item.revents = 0;
+    zmq_pollitem_t poll_items[2];
+    poll_items[0].fd = 0;
+    poll_items[0].socket = socket;
+    poll_items[0].events = ZMQ_POLLIN;
+    poll_items[0].revents = 0;
+
+    // acks queued by the decode threads
+    poll_items[1].fd = m_ackEvent.getFd();
+    poll_items[1].socket = nullptr;
+    poll_items[1].events = ZMQ_POLLIN;
+    poll_items[1].revents = 0;
+
+    auto& poll_item = poll_items[0];
+    int poll_count = m_ackMode ? 2 : 1;
 
     SWSS_LOG_NOTICE("bind to zmq endpoint: %s", m_endpoint.c_str());
     while (m_runThread)
     {
         // receive message
-        rc = zmq_poll(&poll_item, 1, 1000);
+        rc = zmq_poll(poll_items, poll_count, 1000);
+        if (m_ackMode && (poll_items[1].revents & ZMQ_POLLIN))
+        {
+            m_ackEvent.readData();
+            sendQueuedAcks(socket);
+        }
+
         if (rc == 0 || !(poll_item.revents & ZMQ_POLLIN))
         {
             // timeout or other event
@@ -119,11 +425,22 @@ void ZmqServer::mqPollThread()
             continue;
         }
 
-        // receive message
-        rc = zmq_recv(socket, m_buffer.data(), MQ_RESPONSE_MAX_COUNT, ZMQ_DONTWAIT);
+        std::string identity;
+        uint64_t ackId = 0;
+        if (m_ackMode && !receiveEnvelope(socket, identity, ackId))
+        {
+            continue;
+        }
+
+        // receive message, zmq keeps the payload in its own buffer so the
+        // entries are decoded from it without copying the message first
+        zmq_msg_t message;
+        zmq_msg_init(&message);
+        rc = zmq_msg_recv(&message, socket, ZMQ_DONTWAIT);
         if (rc < 0)
         {
             int zmq_err = zmq_errno();
+            zmq_msg_close(&message);
             SWSS_LOG_DEBUG("zmq_recv failed, endpoint: %s,zmqerrno: %d", m_endpoint.c_str(), zmq_err);
             if (zmq_err == EINTR || zmq_err == EAGAIN)
             {
@@ -135,18 +452,45 @@ void ZmqServer::mqPollThread()
             }
         }
 
-        if (rc >= MQ_RESPONSE_MAX_COUNT)
-        {
-            SWSS_LOG_THROW("zmq_recv message was truncated (over %d bytes, received %d), increase buffer size, message DROPPED",
-                    MQ_RESPONSE_MAX_COUNT,
-                    rc);
-        }
-
-        m_buffer.at(rc) = 0; // make sure that we end string with zero before parse
         SWSS_LOG_DEBUG("zmq received %d bytes", rc);
 
         // deserialize and write to redis:
-        handleReceivedData(m_buffer.data(), rc);
+        try
+        {
+            if (!m_decodeWorkers.empty())
+            {
+                dispatchToDecodeThread(message, identity, ackId);
+            }
+            else if (!m_ackMode)
+            {
+                handleReceivedData(static_cast<const char*>(zmq_msg_data(&message)), zmq_msg_size(&message));
+            }
+            else
+            {
+                // the client learns about a failed batch from its ack
+                uint64_t status = MQ_ACK_FAILED;
+                try
+                {
+                    if (handleReceivedData(static_cast<const char*>(zmq_msg_data(&message)), zmq_msg_size(&message)))
+                    {
+                        status = MQ_ACK_OK;
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    SWSS_LOG_ERROR("ZmqServer failed to handle message, endpoint: %s, error: %s", m_endpoint.c_str(), e.what());
+                }
+
+                sendAck(socket, identity, ackId, status);
+            }
+        }
+        catch (...)
+        {
+            zmq_msg_close(&message);
+            throw;
+        }
+
+        zmq_msg_close(&message);
     }
 
     zmq_close(socket);
@@ -155,4 +499,251 @@ void ZmqServer::mqPollThread()
     SWSS_LOG_NOTICE("mqPollThread end");
 }
 
+bool ZmqServer::receiveEnvelope(void* socket, std::string& identity, uint64_t& ackId)
+{
+    zmq_msg_t frame;
+    zmq_msg_init(&frame);
+
+    // the identity frame added by the ROUTER socket, then the batch id of the client
+    bool valid = true;
+    for (int part = 0; part < 2; part++)
+    {
+        int rc = zmq_msg_recv(&frame, socket, ZMQ_DONTWAIT);
+        if (rc < 0)
+        {
+            int zmq_err = zmq_errno();
+            zmq_msg_close(&frame);
+            if (zmq_err == EINTR || zmq_err == EAGAIN)
+            {
+                return false;
+            }
+
+            SWSS_LOG_THROW("zmq_recv failed, endpoint: %s,zmqerrno: %d", m_endpoint.c_str(), zmq_err);
+        }
+
+        if (part == 0)
+        {
+            identity.assign(static_cast<const char*>(zmq_msg_data(&frame)), zmq_msg_size(&frame));
+        }
+        else if (zmq_msg_size(&frame) == sizeof(ackId))
+        {
+            memcpy(&ackId, zmq_msg_data(&frame), sizeof(ackId));
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!zmq_msg_more(&frame))
+        {
+            valid = false;
+            break;
+        }
+    }
+
+    // drop the rest of a message that doesn't come from a ZmqClient
+    while (!valid && zmq_msg_more(&frame))
+    {
+        if (zmq_msg_recv(&frame, socket, ZMQ_DONTWAIT) < 0)
+        {
+            break;
+        }
+    }
+
+    zmq_msg_close(&frame);
+    if (!valid)
+    {
+        SWSS_LOG_WARN("ZmqServer dropped malformed message, endpoint: %s", m_endpoint.c_str());
+    }
+
+    return valid;
+}
+
+void ZmqServer::sendAck(void* socket, const std::string& identity, uint64_t ackId, uint64_t status)
+{
+    uint64_t ack[2] = { ackId, status };
+
+    // ROUTER drops messages to clients that are gone or can't take more
+    int rc = zmq_send(socket, identity.data(), identity.size(), ZMQ_SNDMORE | ZMQ_DONTWAIT);
+    if (rc >= 0)
+    {
+        rc = zmq_send(socket, ack, sizeof(ack), ZMQ_DONTWAIT);
+    }
+
+    if (rc < 0)
+    {
+        SWSS_LOG_WARN("ZmqServer failed to send ack %" PRIu64 ", endpoint: %s, zmqerrno: %d", ackId, m_endpoint.c_str(), zmq_errno());
+    }
+}
+
+void ZmqServer::queueAck(const std::string& identity, uint64_t ackId, uint64_t status)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ackMutex);
+        m_pendingAcks.push_back(PendingAck{identity, ackId, status});
+    }
+
+    m_ackEvent.notify();
+}
+
+void ZmqServer::sendQueuedAcks(void* socket)
+{
+    std::vector<PendingAck> acks;
+    {
+        std::lock_guard<std::mutex> lock(m_ackMutex);
+        acks.swap(m_pendingAcks);
+    }
+
+    for (auto& ack : acks)
+    {
+        sendAck(socket, ack.identity, ack.id, ack.status);
+    }
+}
+
+void ZmqServer::shmPollThread()
+{
+    SWSS_LOG_NOTICE("shmPollThread begin");
+
+    struct ShmPeer
+    {
+        ~ShmPeer()
+        {
+            close(socket);
+        }
+
+        int socket;
+        std::unique_ptr<ShmRing> ring;
+    };
+
+    int listenFd = ShmRing::listen(m_endpoint);
+    std::vector<std::unique_ptr<ShmPeer>> peers;
+    std::vector<struct pollfd> fds;
+
+    SWSS_LOG_NOTICE("listen on shm endpoint: %s", m_endpoint.c_str());
+    while (m_runThread)
+    {
+        // drain before sleeping, a ring that got data meanwhile keeps us polling
+        bool busy = false;
+        for (auto& peer : peers)
+        {
+            busy |= drainShmRing(*peer->ring);
+        }
+
+        for (auto& peer : peers)
+        {
+            busy |= !peer->ring->prepareWait();
+        }
+
+        fds.resize(1 + 2 * peers.size());
+        fds[0].fd = listenFd;
+        fds[0].events = POLLIN;
+        for (size_t i = 0; i < peers.size(); i++)
+        {
+            fds[1 + 2 * i].fd = peers[i]->ring->getEventFd();
+            fds[1 + 2 * i].events = POLLIN;
+            fds[2 + 2 * i].fd = peers[i]->socket;
+            fds[2 + 2 * i].events = POLLIN;
+        }
+
+        int rc = poll(fds.data(), (nfds_t)fds.size(), busy ? 0 : MQ_POLL_TIMEOUT);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            SWSS_LOG_THROW("poll failed, endpoint: %s, errno: %s", m_endpoint.c_str(), strerror(errno));
+        }
+
+        for (size_t i = peers.size(); i > 0; i--)
+        {
+            auto& peer = peers[i - 1];
+            if (fds[2 * i - 1].revents & POLLIN)
+            {
+                peer->ring->clearEvent();
+            }
+
+            // the client closes its socket when it goes away, the ring is drained first
+            if (fds[2 * i].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                drainShmRing(*peer->ring);
+                SWSS_LOG_NOTICE("shm client disconnected, endpoint: %s", m_endpoint.c_str());
+                peers.erase(peers.begin() + (i - 1));
+            }
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                SWSS_LOG_WARN("accept on shm endpoint %s failed, errno: %s", m_endpoint.c_str(), strerror(errno));
+                continue;
+            }
+
+            std::unique_ptr<ShmPeer> peer(new ShmPeer());
+            peer->socket = fd;
+            try
+            {
+                peer->ring.reset(new ShmRing(MQ_SHM_RING_SIZE));
+                ShmRing::sendFds(fd, peer->ring->getMemFd(), peer->ring->getEventFd());
+            }
+            catch (const std::exception& e)
+            {
+                SWSS_LOG_ERROR("failed to set up shm client, endpoint: %s, error: %s", m_endpoint.c_str(), e.what());
+                continue;
+            }
+
+            SWSS_LOG_NOTICE("shm client connected, endpoint: %s", m_endpoint.c_str());
+            peers.push_back(std::move(peer));
+        }
+    }
+
+    peers.clear();
+    close(listenFd);
+
+    SWSS_LOG_NOTICE("shmPollThread end");
+}
+
+bool ZmqServer::drainShmRing(ShmRing& ring)
+{
+    const char* data;
+    size_t length;
+    bool received = false;
+
+    while (ring.read(data, length))
+    {
+        received = true;
+        SWSS_LOG_DEBUG("shm received %zu bytes", length);
+
+        if (m_decodeWorkers.empty())
+        {
+            // decoded in place, the ring slot is released afterwards
+            handleReceivedData(data, length);
+        }
+        else
+        {
+            zmq_msg_t message;
+            zmq_msg_init_size(&message, length);
+            memcpy(zmq_msg_data(&message), data, length);
+            try
+            {
+                dispatchToDecodeThread(message, "", 0);
+            }
+            catch (...)
+            {
+                zmq_msg_close(&message);
+                throw;
+            }
+
+            zmq_msg_close(&message);
+        }
+
+        ring.release();
+    }
+
+    return received;
+}
+
 }
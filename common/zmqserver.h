@@ -1,27 +1,77 @@
 #pragma once
 
+#include <inttypes.h>
 #include <string>
 #include <deque>
 #include <condition_variable>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "table.h"
+#include "keyopfieldsvaluesentry.h"
+#include "selectableevent.h"
+
+typedef struct zmq_msg_t zmq_msg_t;
 
 #define MQ_RESPONSE_MAX_COUNT (16*1024*1024)
 #define MQ_SIZE 100
 #define MQ_MAX_RETRY 10
 #define MQ_POLL_TIMEOUT (1000)
 #define MQ_WATERMARK 10000
+#define MQ_SEND_BUFFER_POOL_SIZE 4
+#define MQ_SEND_BUFFER_KEEP_SIZE (1024*1024)
+#define MQ_ASYNC_QUEUE_SIZE 4096
+#define MQ_ASYNC_BATCH_SIZE 256
+#define MQ_BATCH_MAX_BYTES (1024*1024)
+#define MQ_BATCH_LINGER_USEC 1000
+#define MQ_SHM_RING_SIZE (2*MQ_RESPONSE_MAX_COUNT)
+#define MQ_COMPRESS_THRESHOLD (4*1024)
+#define MQ_DECOMPRESSED_MAX_COUNT (4*MQ_RESPONSE_MAX_COUNT)
+#define MQ_ACK_MAX_IN_FLIGHT 1024
+#define MQ_ACK_TIMEOUT_MS 10000
+#define MQ_ACK_OK 0
+#define MQ_ACK_FAILED 1
+#define MQ_SEQUENCE_MAX_PRODUCERS 64
 
 /***** ZMQ PORT *****/
 static const int ORCH_ZMQ_PORT = 8020;
 
 namespace swss {
 
+class ShmRing;
+
 class ZmqMessageHandler
 {
 public:
     virtual ~ZmqMessageHandler() {};
     virtual void handleReceivedData(const std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>>& kcos) = 0;
+
+    /* Handlers that can consume compact entries directly should override this to avoid the tuple conversion. */
+    virtual void handleReceivedEntries(std::vector<KeyOpFieldsValuesEntry>& entries)
+    {
+        std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> kcos;
+        kcos.reserve(entries.size());
+        for (auto& entry : entries)
+        {
+            kcos.push_back(std::make_shared<KeyOpFieldsValuesTuple>(entry.toTuple()));
+        }
+
+        handleReceivedData(kcos);
+    }
+
+    /*
+     * Called before the entries of a numbered message when messages from
+     * the same producer were lost in between, see ZmqClient::enableSequenceNumbers().
+     * The first message received from a producer counts too when it isn't
+     * the producer's first, e.g. after a server restart. The entries of the
+     * lost messages are unknown, handlers that keep a state should rebuild
+     * it from the persisted table.
+     */
+    virtual void handleSequenceGap(uint64_t producerId, uint64_t lostCount)
+    {
+        SWSS_LOG_WARN("ZMQ handler ignores %" PRIu64 " lost messages of producer %" PRIx64, lostCount, producerId);
+    }
 };
 
 class ZmqServer
@@ -30,7 +80,23 @@ public:
     /* The default value of pop batch size is 128 */
     static constexpr int DEFAULT_POP_BATCH_SIZE = 128;
 
-    ZmqServer(const std::string& endpoint);
+    /*
+     * With decodeThreadCount 0 the poll thread decodes and dispatches every
+     * message. Otherwise the poll thread only reads the message header and
+     * hands the message to one of the decode threads. All messages of a
+     * table go to the same thread, so their order is kept, while a slow
+     * handler of one table doesn't delay the other tables.
+     *
+     * An endpoint "shm://<name>" receives through shared memory rings
+     * instead of libzmq, for clients on the same host, see ShmRing.
+     *
+     * With ackMode the server binds a ROUTER socket for clients that
+     * called ZmqClient::enableAcks(). Every message is acknowledged to its
+     * client once its handler returned, MQ_ACK_FAILED when the handler
+     * threw or there is none. The acks of the decode threads are sent by
+     * the poll thread, which owns the socket. Not for shm endpoints.
+     */
+    ZmqServer(const std::string& endpoint, size_t decodeThreadCount = 0, bool ackMode = false);
     ~ZmqServer();
 
     void registerMessageHandler(
@@ -39,21 +105,101 @@ public:
                                 ZmqMessageHandler* handler);
 
 private:
-    void handleReceivedData(const char* buffer, const size_t size);
+    struct DecodeWorker;
+
+    struct PendingAck
+    {
+        std::string identity;
+        uint64_t id;
+        uint64_t status;
+    };
+
+    struct ProducerSequence
+    {
+        uint64_t nextSequence;
+
+        // HandlerState::messageCount at the last message of the producer
+        uint64_t lastMessage;
+    };
+
+    struct HandlerState
+    {
+        ZmqMessageHandler* handler;
+
+        // only the thread that handles the table touches the sequences,
+        // at most MQ_SEQUENCE_MAX_PRODUCERS producers are tracked
+        std::map<uint64_t, ProducerSequence> producers;
+
+        // numbered messages received
+        uint64_t messageCount = 0;
+    };
+
+    // false when there is no handler for the message
+    bool handleReceivedData(const char* buffer, const size_t size);
+
+    void handleReceivedData(size_t handlerId, const char* buffer, const size_t size);
+
+    // report lost messages of numbered producers to the handler
+    void checkSequence(HandlerState& state, uint64_t producerId, uint64_t sequence);
+
+    // forget the producer that was silent for the most messages
+    void dropStaleProducer(HandlerState& state);
 
     void mqPollThread();
-    
+
+    void shmPollThread();
+
+    // consume every message queued in the ring, false when there was none
+    bool drainShmRing(ShmRing& ring);
+
+    void decodeThread(DecodeWorker* worker);
+
+    // an empty identity means the message wants no ack
+    void dispatchToDecodeThread(zmq_msg_t& message, const std::string& identity, uint64_t ackId);
+
+    // read the identity and batch id frames of a ROUTER message, false when there are none
+    bool receiveEnvelope(void* socket, std::string& identity, uint64_t& ackId);
+
+    void sendAck(void* socket, const std::string& identity, uint64_t ackId, uint64_t status);
+
+    // called by the decode threads, the poll thread sends the ack
+    void queueAck(const std::string& identity, uint64_t ackId, uint64_t status);
+
+    void sendQueuedAcks(void* socket);
+
+    void stopDecodeThreads();
+
     ZmqMessageHandler* findMessageHandler(const std::string dbName, const std::string tableName);
 
-    std::vector<char> m_buffer;
+    // id of the registered handler, or -1 when there is none
+    int findMessageHandlerId(const std::string& dbName, const std::string& tableName);
+
+    HandlerState& getHandlerState(size_t handlerId);
 
     volatile bool m_runThread;
 
     std::shared_ptr<std::thread> m_mqPollThread;
 
+    std::vector<std::unique_ptr<DecodeWorker>> m_decodeWorkers;
+
     std::string m_endpoint;
 
-    std::map<std::string, std::map<std::string, ZmqMessageHandler*>> m_HandlerMap;
+    // handlers may be registered while the poll and decode threads look them up
+    std::mutex m_handlerMutex;
+
+    // db name -> table name -> handler id, the id indexes m_handlers
+    std::map<std::string, std::map<std::string, size_t>> m_HandlerMap;
+
+    std::vector<std::unique_ptr<HandlerState>> m_handlers;
+
+    bool m_ackMode;
+
+    std::mutex m_ackMutex;
+
+    std::vector<PendingAck> m_pendingAcks;
+
+    // wakes the poll thread when acks are queued
+    SelectableEvent m_ackEvent;
 };
 
 }
@@ -38,6 +38,7 @@
 #include "profileprovider.h"
 #include "consumertable.h"
 #include "subscriberstatetable.h"
+#include "keyspacedispatcher.h"
 #ifdef ENABLE_YANG_MODULES
 #include "decoratortable.h"
 #include "defaultvalueprovider.h"
@@ -277,6 +278,7 @@ T castSelectableObj(swss::Selectable *temp)
 %include "redispipeline.h"
 %include "redisreply.h"
 %include "redisselect.h"
+%include "keyspacedispatcher.h"
 %include "redistran.h"
 %include "configdb.h"
 %include "zmqserver.h"
@@ -125,3 +125,244 @@ TEST(BinarySerializer, protocol_buffer)
     EXPECT_EQ(db_table, test_table);
     EXPECT_EQ(deserialized_kcos, kcos);
 }
+
+TEST(BinarySerializer, deserialize_entries)
+{
+    char buffer[400];
+    std::vector<FieldValueTuple> values;
+    for (int i = 0; i < 6; i++)
+    {
+        values.push_back(std::make_pair("field" + to_string(i), "value" + to_string(i)));
+    }
+
+    std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
+        KeyOpFieldsValuesTuple{"test_key", "SET", values},
+        KeyOpFieldsValuesTuple{"test_key_2", "DEL", std::vector<FieldValueTuple>{}}};
+    int serialized_len = (int)BinarySerializer::serializeBuffer(
+                                                                buffer,
+                                                                sizeof(buffer),
+                                                                "test_db",
+                                                                "test_table",
+                                                                kcos);
+
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    string db_name;
+    string db_table;
+    BinarySerializer::deserializeBuffer(buffer, serialized_len, db_name, db_table, entries);
+
+    EXPECT_EQ(db_name, "test_db");
+    EXPECT_EQ(db_table, "test_table");
+    ASSERT_EQ(entries.size(), kcos.size());
+    for (size_t i = 0; i < kcos.size(); i++)
+    {
+        EXPECT_EQ(entries[i].toTuple(), kcos[i]);
+    }
+
+    entries.clear();
+    EXPECT_THROW(BinarySerializer::deserializeBuffer(buffer, serialized_len - 10, db_name, db_table, entries), runtime_error);
+}
+
+TEST(BinarySerializer, serialized_size)
+{
+    std::vector<FieldValueTuple> values;
+    for (int i = 0; i < 12; i++)
+    {
+        values.push_back(std::make_pair("field" + to_string(i), "value" + to_string(i)));
+    }
+    std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
+        KeyOpFieldsValuesTuple{"test_entry_key", "SET", values},
+        KeyOpFieldsValuesTuple{"test_entry_key2", "DEL", std::vector<FieldValueTuple>{}}};
+
+    size_t size = BinarySerializer::serializedSize("test_db", "test_table", kcos);
+
+    // the buffer grows to exactly the size of the batch
+    std::vector<char> buffer;
+    size_t serialized_len = BinarySerializer::serializeBuffer(buffer, "test_db", "test_table", kcos);
+    EXPECT_EQ(serialized_len, size);
+    EXPECT_EQ(buffer.size(), size);
+
+    std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> kcos_ptrs;
+    string db_name;
+    string db_table;
+    BinarySerializer::deserializeBuffer(buffer.data(), serialized_len, db_name, db_table, kcos_ptrs);
+    ASSERT_EQ(kcos_ptrs.size(), 2U);
+    EXPECT_EQ(kfvFieldsValues(*kcos_ptrs[0]), values);
+    EXPECT_EQ(kfvOp(*kcos_ptrs[1]), DEL_COMMAND);
+
+    // a bigger buffer is reused as is
+    buffer.resize(size * 2);
+    EXPECT_EQ(BinarySerializer::serializeBuffer(buffer, "test_db", "test_table", kcos), size);
+    EXPECT_EQ(buffer.size(), size * 2);
+}
+
+TEST(BinarySerializer, message_header)
+{
+    std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
+        KeyOpFieldsValuesTuple{"test_entry_key", "SET", std::vector<FieldValueTuple>{{"field", "value"}}}};
+
+    size_t header_size = BinarySerializer::MESSAGE_HEADER_SIZE;
+    std::vector<char> buffer(header_size + BinarySerializer::serializedSize("test_db", "test_table", kcos));
+
+    BinarySerializer::MessageHeader header;
+    header.flags = BinarySerializer::FLAG_SEQUENCE;
+    header.producerId = 0x1234;
+    BinarySerializer::serializeMessageHeader(buffer.data(), header);
+    BinarySerializer::setMessageSequence(buffer.data(), 42);
+    size_t serialized_len = header_size + BinarySerializer::serializeBuffer(
+                                                            buffer.data() + header_size,
+                                                            buffer.size() - header_size,
+                                                            "test_db",
+                                                            "test_table",
+                                                            kcos);
+
+    BinarySerializer::MessageHeader received;
+    size_t offset = BinarySerializer::deserializeMessageHeader(buffer.data(), serialized_len, received);
+    EXPECT_EQ(offset, header_size);
+    EXPECT_EQ(received.flags, (uint64_t)BinarySerializer::FLAG_SEQUENCE);
+    EXPECT_EQ(received.producerId, 0x1234U);
+    EXPECT_EQ(received.sequence, 42U);
+
+    string db_name;
+    string db_table;
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    BinarySerializer::deserializeBuffer(buffer.data() + offset, serialized_len - offset, db_name, db_table, entries);
+    EXPECT_EQ(db_table, "test_table");
+    ASSERT_EQ(entries.size(), 1U);
+
+    // messages without the header decode as before
+    offset = BinarySerializer::deserializeMessageHeader(buffer.data() + header_size, serialized_len - header_size, received);
+    EXPECT_EQ(offset, 0U);
+    EXPECT_EQ(received.flags, 0U);
+
+    // a truncated header fails
+    EXPECT_THROW(BinarySerializer::deserializeMessageHeader(buffer.data(), header_size - 1, received), runtime_error);
+}
+
+TEST(BinarySerializer, compress_body)
+{
+    std::vector<KeyOpFieldsValuesTuple> kcos;
+    for (int i = 0; i < 100; i++)
+    {
+        kcos.push_back(KeyOpFieldsValuesTuple{"10.0.0." + to_string(i) + "/32", "SET", std::vector<FieldValueTuple>{
+            {"nexthop", "10.1.0.1,10.1.0.3,10.1.0.5"}, {"ifname", "Ethernet0,Ethernet4,Ethernet8"}}});
+    }
+
+    std::vector<char> buffer;
+    size_t serialized_len = BinarySerializer::serializeBuffer(buffer, "test_db", "test_table", kcos);
+
+    std::vector<char> compressed(serialized_len);
+    size_t compressed_len = BinarySerializer::compressBody(buffer.data(), serialized_len, compressed.data(), compressed.size());
+    ASSERT_GT(compressed_len, 0U);
+    EXPECT_LT(compressed_len, serialized_len / 2);
+
+    // the header stays readable
+    string db_name;
+    string db_table;
+    BinarySerializer::deserializeHeader(compressed.data(), compressed_len, db_name, db_table);
+    EXPECT_EQ(db_name, "test_db");
+    EXPECT_EQ(db_table, "test_table");
+
+    std::vector<char> decompressed;
+    BinarySerializer::decompressBody(compressed.data(), compressed_len, serialized_len, decompressed);
+    ASSERT_EQ(decompressed.size(), serialized_len);
+    EXPECT_EQ(memcmp(decompressed.data(), buffer.data(), serialized_len), 0);
+
+    // the size limit of the receiver holds
+    EXPECT_THROW(BinarySerializer::decompressBody(compressed.data(), compressed_len, serialized_len - 1, decompressed), runtime_error);
+
+    // no room to gain, no output
+    EXPECT_EQ(BinarySerializer::compressBody(buffer.data(), serialized_len, compressed.data(), 40), 0U);
+}
+
+TEST(BinarySerializer, wire_version_2)
+{
+    std::vector<KeyOpFieldsValuesTuple> kcos;
+    for (int i = 0; i < 100; i++)
+    {
+        kcos.push_back(KeyOpFieldsValuesTuple{"10.0.0." + to_string(i) + "/32", "SET", std::vector<FieldValueTuple>{
+            {"nexthop", "10.1.0.1"}, {"ifname", "Ethernet0"}}});
+    }
+    kcos.push_back(KeyOpFieldsValuesTuple{"10.0.1.0/24", "DEL", std::vector<FieldValueTuple>{}});
+    // ops and fields the version 1 format can't carry
+    kcos.push_back(KeyOpFieldsValuesTuple{"10.0.2.0/24", "DEL", std::vector<FieldValueTuple>{{"ifname", "Ethernet4"}}});
+    kcos.push_back(KeyOpFieldsValuesTuple{"10.0.3.0/24", "GET", std::vector<FieldValueTuple>{{"protocol", "bgp"}}});
+
+    uint8_t v1 = BinarySerializer::WIRE_VERSION_1;
+    uint8_t v2 = BinarySerializer::WIRE_VERSION_2;
+
+    std::vector<char> buffer_v1;
+    size_t size_v1 = BinarySerializer::serializeBuffer(buffer_v1, "test_db", "test_table", kcos);
+    std::vector<char> buffer;
+    size_t size = BinarySerializer::serializedSize("test_db", "test_table", kcos, v2);
+    EXPECT_EQ(BinarySerializer::serializeBuffer(buffer, "test_db", "test_table", kcos, v2), size);
+    EXPECT_LT(size, size_v1 / 2);
+
+    EXPECT_EQ(BinarySerializer::getWireVersion(buffer_v1.data(), size_v1), v1);
+    EXPECT_EQ(BinarySerializer::getWireVersion(buffer.data(), size), v2);
+
+    string db_name;
+    string db_table;
+    BinarySerializer::deserializeHeader(buffer.data(), size, db_name, db_table);
+    EXPECT_EQ(db_name, "test_db");
+    EXPECT_EQ(db_table, "test_table");
+
+    std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>> kcos_ptrs;
+    BinarySerializer::deserializeBuffer(buffer.data(), size, db_name, db_table, kcos_ptrs);
+    std::vector<KeyOpFieldsValuesTuple> deserialized_kcos;
+    for (auto kco_ptr : kcos_ptrs)
+    {
+        deserialized_kcos.push_back(*kco_ptr);
+    }
+    EXPECT_EQ(deserialized_kcos, kcos);
+
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    BinarySerializer::deserializeBuffer(buffer.data(), size, db_name, db_table, entries);
+    ASSERT_EQ(entries.size(), kcos.size());
+    EXPECT_EQ(entries[102].getOp(), KeyOpFieldsValuesEntry::Op::OTHER);
+    EXPECT_EQ(entries[102].toTuple(), kcos[102]);
+
+    std::vector<FieldValueTuple> values;
+    BinarySerializer::deserializeBuffer(buffer.data(), size, values);
+    ASSERT_EQ(values.size(), 1 + 100 * 3 + 1 + 2 + 2U);
+    EXPECT_EQ(values[0], FieldValueTuple("test_db", "test_table"));
+    EXPECT_EQ(values[1], FieldValueTuple("10.0.0.0/32", "2"));
+
+    // a compressed version 2 body restores as is
+    std::vector<char> compressed(size);
+    size_t compressed_len = BinarySerializer::compressBody(buffer.data(), size, compressed.data(), compressed.size());
+    ASSERT_GT(compressed_len, 0U);
+    std::vector<char> decompressed;
+    BinarySerializer::decompressBody(compressed.data(), compressed_len, size, decompressed);
+    ASSERT_EQ(decompressed.size(), size);
+    EXPECT_EQ(memcmp(decompressed.data(), buffer.data(), size), 0);
+
+    // too small buffer
+    EXPECT_THROW(BinarySerializer::serializeBuffer(buffer.data(), size - 1, "test_db", "test_table", kcos, v2), runtime_error);
+}
+
+TEST(BinarySerializer, wire_version_2_corrupted)
+{
+    std::vector<KeyOpFieldsValuesTuple> kcos = std::vector<KeyOpFieldsValuesTuple>{
+        KeyOpFieldsValuesTuple{"key_1", "SET", std::vector<FieldValueTuple>{{"field", "value"}}},
+        KeyOpFieldsValuesTuple{"key_2", "SET", std::vector<FieldValueTuple>{{"field", "value"}}}};
+
+    std::vector<char> buffer;
+    size_t size = BinarySerializer::serializeBuffer(buffer, "test_db", "test_table", kcos, BinarySerializer::WIRE_VERSION_2);
+
+    string db_name;
+    string db_table;
+    std::vector<KeyOpFieldsValuesEntry> entries;
+    for (size_t truncated = BinarySerializer::WIRE_PREAMBLE_SIZE; truncated < size; truncated++)
+    {
+        EXPECT_THROW(BinarySerializer::deserializeBuffer(buffer.data(), truncated, db_name, db_table, entries), runtime_error);
+    }
+
+    // the second entry refers to the first name, point it past the dictionary
+    ASSERT_EQ(buffer[size - 7], 1);
+    buffer[size - 7] = 2;
+    EXPECT_THROW(BinarySerializer::deserializeBuffer(buffer.data(), size, db_name, db_table, entries), runtime_error);
+
+    // unknown version
+    buffer[BinarySerializer::WIRE_PREAMBLE_SIZE - 1] = 3;
+    EXPECT_THROW(BinarySerializer::getWireVersion(buffer.data(), size), runtime_error);
+}
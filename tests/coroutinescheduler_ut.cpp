@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <string.h>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include "common/coroutinescheduler.h"
+#include "common/selectableevent.h"
+#include "common/selectabletimer.h"
+
+using namespace std;
+using namespace swss;
+
+TEST(CoroutineScheduler, ping_pong)
+{
+    CoroutineScheduler scheduler;
+    SelectableEvent ping;
+    SelectableEvent pong;
+    vector<string> trace;
+
+    scheduler.spawn([&]() {
+        for (int i = 0; i < 3; i++)
+        {
+            trace.push_back("ping");
+            ping.notify();
+            scheduler.wait(&pong);
+        }
+    });
+
+    scheduler.spawn([&]() {
+        for (int i = 0; i < 3; i++)
+        {
+            scheduler.wait(&ping);
+            trace.push_back("pong");
+            pong.notify();
+        }
+    });
+
+    EXPECT_EQ(scheduler.run(1000), Select::OBJECT);
+    EXPECT_EQ(scheduler.getCoroutineCount(), 0U);
+    EXPECT_EQ(trace, vector<string>({"ping", "pong", "ping", "pong", "ping", "pong"}));
+}
+
+TEST(CoroutineScheduler, timer)
+{
+    CoroutineScheduler scheduler;
+    timespec interval = { .tv_sec = 0, .tv_nsec = 10000000 };
+    SelectableTimer timer(interval);
+    int ticks = 0;
+
+    scheduler.spawn([&]() {
+        timer.start();
+        while (ticks < 3)
+        {
+            scheduler.wait(&timer);
+            ticks++;
+        }
+        timer.stop();
+        scheduler.removeSelectable(&timer);
+    });
+
+    EXPECT_EQ(scheduler.run(1000), Select::OBJECT);
+    EXPECT_EQ(ticks, 3);
+}
+
+TEST(CoroutineScheduler, pending_wakeup)
+{
+    CoroutineScheduler scheduler;
+    SelectableEvent event;
+    SelectableEvent other;
+    bool woken = false;
+
+    scheduler.spawn([&]() {
+        scheduler.wait(&event);
+        event.notify();
+        // nobody waits for the event while this one waits for the other
+        scheduler.wait(&other);
+        scheduler.wait(&event);
+        woken = true;
+    });
+
+    scheduler.spawn([&]() {
+        event.notify();
+        scheduler.yield();
+        scheduler.yield();
+        other.notify();
+    });
+
+    EXPECT_EQ(scheduler.run(1000), Select::OBJECT);
+    EXPECT_TRUE(woken);
+}
+
+TEST(CoroutineScheduler, timeout_and_exception)
+{
+    CoroutineScheduler scheduler;
+    SelectableEvent event;
+
+    scheduler.spawn([&]() {
+        scheduler.wait(&event);
+        throw runtime_error("handler failed");
+    });
+
+    EXPECT_EQ(scheduler.run(10), Select::TIMEOUT);
+    EXPECT_EQ(scheduler.getCoroutineCount(), 1U);
+
+    event.notify();
+    EXPECT_THROW(scheduler.run(1000), runtime_error);
+    EXPECT_EQ(scheduler.getCoroutineCount(), 0U);
+
+    // wait() is only allowed inside a coroutine
+    EXPECT_THROW(scheduler.wait(&event), runtime_error);
+}
+
+TEST(CoroutineScheduler, stack_rounded_to_pages)
+{
+    CoroutineScheduler scheduler(100000);
+    int depth = 0;
+
+    scheduler.spawn([&]() {
+        // touch most of the requested size
+        char buffer[64 * 1024];
+        memset(buffer, 1, sizeof(buffer));
+        depth = buffer[sizeof(buffer) - 1];
+    });
+
+    auto &coroutine = *scheduler.m_coroutines.front();
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    EXPECT_EQ(coroutine.mappedSize % pageSize, 0U);
+    EXPECT_GE(coroutine.mappedSize, 100000 + pageSize);
+    EXPECT_EQ(coroutine.context.uc_stack.ss_sp, coroutine.stack + pageSize);
+
+    EXPECT_EQ(scheduler.run(1000), Select::OBJECT);
+    EXPECT_EQ(depth, 1);
+}
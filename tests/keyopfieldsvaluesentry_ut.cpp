@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "common/table.h"
+#include "common/keyopfieldsvaluesentry.h"
+
+using namespace std;
+using namespace swss;
+
+TEST(KeyOpFieldsValuesEntry, tuple_conversion)
+{
+    vector<FieldValueTuple> values;
+    for (int i = 0; i < 10; i++)
+    {
+        values.push_back(make_pair("field" + to_string(i), "value" + to_string(i)));
+    }
+
+    KeyOpFieldsValuesTuple set_kco{"set_key", SET_COMMAND, values};
+    KeyOpFieldsValuesEntry set_entry(set_kco);
+    EXPECT_EQ(set_entry.getKey(), "set_key");
+    EXPECT_EQ(set_entry.getOp(), KeyOpFieldsValuesEntry::Op::SET);
+    EXPECT_EQ(set_entry.getFieldCount(), values.size());
+    EXPECT_EQ(set_entry.getField(7), "field7");
+    EXPECT_EQ(set_entry.getValue(7), "value7");
+    EXPECT_EQ(set_entry.toTuple(), set_kco);
+
+    KeyOpFieldsValuesTuple del_kco{"del_key", DEL_COMMAND, vector<FieldValueTuple>{}};
+    KeyOpFieldsValuesEntry del_entry(del_kco);
+    EXPECT_EQ(del_entry.getOp(), KeyOpFieldsValuesEntry::Op::DEL);
+    EXPECT_EQ(del_entry.getFieldCount(), 0U);
+    EXPECT_EQ(del_entry.toTuple(), del_kco);
+}
+
+TEST(KeyOpFieldsValuesEntry, custom_op)
+{
+    KeyOpFieldsValuesTuple kco{"key", "bulkset", vector<FieldValueTuple>{{"f", "v"}}};
+    KeyOpFieldsValuesEntry entry(kco);
+    EXPECT_EQ(entry.getOp(), KeyOpFieldsValuesEntry::Op::OTHER);
+    EXPECT_EQ(entry.getOpString(), "bulkset");
+    EXPECT_EQ(entry.getKey(), "key");
+    EXPECT_EQ(entry.getField(0), "f");
+    EXPECT_EQ(entry.getValue(0), "v");
+    EXPECT_EQ(entry.toTuple(), kco);
+}
+
+TEST(KeyOpFieldsValuesEntry, reuse)
+{
+    KeyOpFieldsValuesEntry entry("key", KeyOpFieldsValuesEntry::Op::SET);
+    entry.addField("f1", "v1");
+    entry.addField(string("f\0x", 3), string());
+
+    auto kco = entry.toTuple();
+    ASSERT_EQ(kfvFieldsValues(kco).size(), 2U);
+    EXPECT_EQ(fvField(kfvFieldsValues(kco)[1]), string("f\0x", 3));
+    EXPECT_EQ(fvValue(kfvFieldsValues(kco)[1]), "");
+
+    entry.reset("key2", 4, DEL_COMMAND);
+    EXPECT_EQ(entry.toTuple(), (KeyOpFieldsValuesTuple{"key2", DEL_COMMAND, vector<FieldValueTuple>{}}));
+}
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "common/lzcodec.h"
+
+using namespace std;
+using namespace swss;
+
+static string roundTrip(const string &input, size_t &compressedSize)
+{
+    vector<char> compressed(LzCodec::compressBound(input.size()));
+    compressedSize = LzCodec::compress(input.data(), input.size(), compressed.data(), compressed.size());
+    EXPECT_GT(compressedSize, 0U);
+
+    string output(input.size(), '\0');
+    LzCodec::decompress(compressed.data(), compressedSize, &output[0], output.size());
+    return output;
+}
+
+TEST(LzCodec, round_trip)
+{
+    size_t compressedSize;
+
+    string text;
+    for (int i = 0; i < 1000; i++)
+    {
+        text += "ROUTE_TABLE:10.0.";
+        text += to_string(i % 256) + "." + to_string(i / 256) + "/32";
+        text += "nexthop10.0.0.1,10.0.0.3ifnameEthernet0,Ethernet4";
+    }
+    EXPECT_EQ(roundTrip(text, compressedSize), text);
+    EXPECT_LT(compressedSize, text.size() / 4);
+
+    // a match that overlaps its own output
+    string run(100000, 'a');
+    EXPECT_EQ(roundTrip(run, compressedSize), run);
+    EXPECT_LT(compressedSize, 1000U);
+
+    // data that doesn't compress still fits in the bound
+    string noise;
+    uint32_t seed = 1;
+    for (int i = 0; i < 100000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        noise += (char)(seed >> 24);
+    }
+    EXPECT_EQ(roundTrip(noise, compressedSize), noise);
+
+    EXPECT_EQ(roundTrip("", compressedSize), "");
+    EXPECT_EQ(roundTrip("abc", compressedSize), "abc");
+}
+
+TEST(LzCodec, small_capacity)
+{
+    string noise;
+    uint32_t seed = 7;
+    for (int i = 0; i < 1000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        noise += (char)(seed >> 24);
+    }
+
+    // no gain, no output
+    vector<char> compressed(noise.size() - 1);
+    EXPECT_EQ(LzCodec::compress(noise.data(), noise.size(), compressed.data(), compressed.size()), 0U);
+}
+
+TEST(LzCodec, corrupt_input)
+{
+    string text(1000, 'x');
+    vector<char> compressed(LzCodec::compressBound(text.size()));
+    size_t compressedSize = LzCodec::compress(text.data(), text.size(), compressed.data(), compressed.size());
+    ASSERT_GT(compressedSize, 0U);
+
+    string output(text.size(), '\0');
+
+    // wrong size
+    EXPECT_THROW(LzCodec::decompress(compressed.data(), compressedSize, &output[0], output.size() - 1), runtime_error);
+    EXPECT_THROW(LzCodec::decompress(compressed.data(), compressedSize - 1, &output[0], output.size()), runtime_error);
+
+    // a match before the start of the output
+    const char bad[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    EXPECT_THROW(LzCodec::decompress(bad, sizeof(bad), &output[0], 10), runtime_error);
+}
@@ -0,0 +1,182 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "gtest/gtest.h"
+#include "common/parallelselect.h"
+#include "common/selectableevent.h"
+
+using namespace std;
+using namespace swss;
+
+static bool waitFor(function<bool()> predicate, int timeoutMs = 5000)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    while (!predicate())
+    {
+        if (chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return true;
+}
+
+TEST(ParallelSelect, handler_called)
+{
+    ParallelSelect ps(2);
+    SelectableEvent event;
+    atomic<int> calls(0);
+
+    ps.addSelectable(&event, [&](Selectable *sel) {
+            EXPECT_EQ(sel, &event);
+            calls++;
+        });
+
+    event.notify();
+    EXPECT_TRUE(waitFor([&]() { return calls == 1; }));
+
+    event.notify();
+    EXPECT_TRUE(waitFor([&]() { return calls == 2; }));
+
+    ps.removeSelectable(&event);
+}
+
+TEST(ParallelSelect, one_handler_per_selectable)
+{
+    ParallelSelect ps(4);
+    SelectableEvent event;
+    atomic<int> running(0);
+    atomic<int> maxRunning(0);
+    atomic<int> calls(0);
+
+    ps.addSelectable(&event, [&](Selectable *) {
+            int now = ++running;
+            maxRunning = max(maxRunning.load(), now);
+            this_thread::sleep_for(chrono::milliseconds(5));
+            running--;
+            calls++;
+        });
+
+    for (int i = 0; i < 20; i++)
+    {
+        event.notify();
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(waitFor([&]() { return calls > 0 && running == 0; }));
+    ps.removeSelectable(&event);
+    EXPECT_EQ(maxRunning, 1);
+}
+
+TEST(ParallelSelect, independent_selectables_run_concurrently)
+{
+    ParallelSelect ps(2);
+    SelectableEvent slow;
+    SelectableEvent fast;
+    mutex m;
+    condition_variable cv;
+    bool release = false;
+    atomic<bool> fastDone(false);
+
+    ps.addSelectable(&slow, [&](Selectable *) {
+            unique_lock<mutex> lock(m);
+            cv.wait_for(lock, chrono::seconds(5), [&]() { return release; });
+        });
+    ps.addSelectable(&fast, [&](Selectable *) {
+            fastDone = true;
+        });
+
+    slow.notify();
+    this_thread::sleep_for(chrono::milliseconds(10));
+    fast.notify();
+
+    // the fast handler is not stalled by the blocked one
+    EXPECT_TRUE(waitFor([&]() { return fastDone.load(); }, 2000));
+
+    {
+        lock_guard<mutex> lock(m);
+        release = true;
+    }
+    cv.notify_all();
+
+    ps.removeSelectable(&slow);
+    ps.removeSelectable(&fast);
+}
+
+TEST(ParallelSelect, remove_waits_for_handler)
+{
+    ParallelSelect ps(1);
+    SelectableEvent event;
+    atomic<bool> started(false);
+    atomic<bool> finished(false);
+
+    ps.addSelectable(&event, [&](Selectable *) {
+            started = true;
+            this_thread::sleep_for(chrono::milliseconds(50));
+            finished = true;
+        });
+
+    event.notify();
+    EXPECT_TRUE(waitFor([&]() { return started.load(); }));
+
+    ps.removeSelectable(&event);
+    EXPECT_TRUE(finished);
+
+    // no more dispatch once removed
+    started = false;
+    event.notify();
+    this_thread::sleep_for(chrono::milliseconds(50));
+    EXPECT_FALSE(started);
+}
+
+TEST(ParallelSelect, remove_from_own_handler)
+{
+    ParallelSelect ps(1);
+    SelectableEvent event;
+    atomic<int> calls(0);
+    atomic<bool> removed(false);
+
+    ps.addSelectable(&event, [&](Selectable *sel) {
+            calls++;
+            ps.removeSelectable(sel);
+            removed = true;
+        });
+
+    event.notify();
+    EXPECT_TRUE(waitFor([&]() { return removed.load(); }));
+
+    // no more dispatch once the handler returned
+    event.notify();
+    this_thread::sleep_for(chrono::milliseconds(50));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ParallelSelect, suspended_selectable_stays_registered)
+{
+    Select s;
+    SelectableEvent event;
+    Selectable *sel;
+
+    s.addSuspendable(&event);
+
+    event.notify();
+    EXPECT_EQ(s.select(&sel, 100), Select::OBJECT);
+    EXPECT_EQ(sel, &event);
+
+    // neither polled nor read until resumed
+    event.notify();
+    EXPECT_EQ(s.select(&sel, 10), Select::TIMEOUT);
+    EXPECT_EQ(s.m_objects.size(), 1u);
+
+    s.resume(&event);
+    EXPECT_EQ(s.select(&sel, 100), Select::OBJECT);
+    EXPECT_EQ(sel, &event);
+
+    s.resume(&event);
+    EXPECT_EQ(s.select(&sel, 10), Select::TIMEOUT);
+
+    s.removeSelectable(&event);
+}
@@ -1223,3 +1223,39 @@ TEST(ConsumerStateTable, multitable)
 
     cout << endl << "Done." << endl;
 }
+
+TEST(ConsumerStateTable, collapse_notifications)
+{
+    clearDB();
+
+    string tableName = "UT_REDIS_THREAD_0";
+    DBConnector db(TEST_DB, 0, true);
+    ProducerStateTable p(&db, tableName);
+
+    ConsumerStateTable c(&db, tableName, 5);
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&c);
+
+    /* One notification per key */
+    for (int i = 0; i < 20; i++)
+    {
+        p.set(key(i), vector<FieldValueTuple>{{"field", "value"}});
+    }
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    /* Four batches drain the key set, no empty pops after that */
+    int selects = 0;
+    size_t popped = 0;
+    deque<KeyOpFieldsValuesTuple> vkco;
+    while (cs.select(&selectcs, 500) == Select::OBJECT)
+    {
+        selects++;
+        c.pops(vkco);
+        EXPECT_FALSE(vkco.empty());
+        popped += vkco.size();
+    }
+
+    EXPECT_EQ(popped, 20U);
+    EXPECT_EQ(selects, 4);
+}
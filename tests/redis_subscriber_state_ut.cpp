@@ -2,12 +2,15 @@
 #include <memory>
 #include <thread>
 #include <algorithm>
+#include <map>
+#include <set>
 #include "gtest/gtest.h"
 #include "common/dbconnector.h"
 #include "common/select.h"
 #include "common/selectableevent.h"
 #include "common/table.h"
 #include "common/subscriberstatetable.h"
+#include "common/keyspacedispatcher.h"
 
 using namespace std;
 using namespace swss;
@@ -635,3 +638,236 @@ TEST(SubscriberStateTable, cachedData)
         EXPECT_TRUE(r);
     }
 }
+
+TEST(SubscriberStateTable, coalesce_events)
+{
+    clearDB();
+
+    /* Prepare producer */
+    int index = 0;
+    DBConnector db("TEST_DB", 0, true);
+    Table p(&db, testTableName);
+    string key1 = "TheKey1";
+    string key2 = "TheKey2";
+    string key3 = "TheKey3";
+    int maxNumOfFields = 50;
+
+    /* key3 exists with two fields before the subscriber starts */
+    p.set(key3, vector<FieldValueTuple>{FieldValueTuple(field(index, 0), value(index, 0)), FieldValueTuple(field(index, 1), value(index, 1))});
+
+    /* Prepare subscriber */
+    SubscriberStateTable c(&db, testTableName);
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&c);
+
+    std::deque<KeyOpFieldsValuesTuple> entries;
+    c.pops(entries);
+    ASSERT_EQ(entries.size(), 1U);
+
+    /* Update key1 field by field, set and delete key2 */
+    for (int j = 0; j < maxNumOfFields; j++)
+    {
+        p.hset(key1, field(index, j), value(index, j));
+    }
+    p.set(key2, vector<FieldValueTuple>{FieldValueTuple(field(index, 0), value(index, 0))});
+    p.del(key2);
+
+    /* Delete key3 and set it again with a single field */
+    p.del(key3);
+    p.hset(key3, field(index, 2), value(index, 2));
+
+    /* Make sure all the keyspace events are buffered by one read */
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    int ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+
+    c.pops(entries);
+    ASSERT_EQ(entries.size(), 4U);
+
+    EXPECT_EQ(kfvKey(entries[0]), key1);
+    EXPECT_EQ(kfvOp(entries[0]), "SET");
+    EXPECT_EQ(kfvFieldsValues(entries[0]).size(), (size_t)maxNumOfFields);
+
+    EXPECT_EQ(kfvKey(entries[1]), key2);
+    EXPECT_EQ(kfvOp(entries[1]), "DEL");
+
+    /* The DEL isn't lost to the SET that followed it */
+    EXPECT_EQ(kfvKey(entries[2]), key3);
+    EXPECT_EQ(kfvOp(entries[2]), "DEL");
+    EXPECT_EQ(kfvKey(entries[3]), key3);
+    EXPECT_EQ(kfvOp(entries[3]), "SET");
+    ASSERT_EQ(kfvFieldsValues(entries[3]).size(), 1U);
+    EXPECT_EQ(fvField(kfvFieldsValues(entries[3])[0]), field(index, 2));
+
+    /* All events were consumed by the single pops */
+    ret = cs.select(&selectcs, 1000);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+}
+
+TEST(SubscriberStateTable, pops_initial_batched)
+{
+    clearDB();
+
+    /* Prepare more entries than a single SCAN/HGETALL batch */
+    int index = 0;
+    int numOfKeys = (int)Table::GET_ENTRIES_BATCH_SIZE * 3 + 1;
+    DBConnector db("TEST_DB", 0, true);
+    Table p(&db, testTableName);
+    for (int i = 0; i < numOfKeys; i++)
+    {
+        p.set(key(index, i), vector<FieldValueTuple>{FieldValueTuple(field(index, i), value(index, i))});
+    }
+
+    /* Prepare subscriber */
+    SubscriberStateTable c(&db, testTableName);
+    std::deque<KeyOpFieldsValuesTuple> entries;
+    c.pops(entries);
+    ASSERT_EQ(entries.size(), (size_t)numOfKeys);
+
+    set<string> keys;
+    for (auto &kco : entries)
+    {
+        EXPECT_EQ(kfvOp(kco), "SET");
+        ASSERT_EQ(kfvFieldsValues(kco).size(), 1U);
+
+        int i = readNumberAtEOL(kfvKey(kco));
+        EXPECT_EQ(fvField(kfvFieldsValues(kco)[0]), field(index, i));
+        EXPECT_EQ(fvValue(kfvFieldsValues(kco)[0]), value(index, i));
+        keys.insert(kfvKey(kco));
+    }
+
+    EXPECT_EQ(keys.size(), (size_t)numOfKeys);
+}
+
+TEST(SubscriberStateTable, pops_delta)
+{
+    clearDB();
+
+    /* Prepare producer */
+    DBConnector db("TEST_DB", 0, true);
+    Table p(&db, testTableName);
+    string key = "TheKey";
+    p.set(key, vector<FieldValueTuple>{{"admin_status", "up"}, {"oper_status", "down"}});
+
+    /* Prepare subscriber, the initial content is reported as added fields */
+    SubscriberStateTable c(&db, testTableName);
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&c);
+
+    std::deque<KeyOpFieldsValuesDelta> deltas;
+    c.popsDelta(deltas);
+    ASSERT_EQ(deltas.size(), 1U);
+    EXPECT_EQ(deltas[0].key, key);
+    EXPECT_EQ(deltas[0].op, "SET");
+    ASSERT_EQ(deltas[0].fields.size(), 2U);
+    for (auto &fd : deltas[0].fields)
+    {
+        EXPECT_EQ(fd.oldValue, nullptr);
+        ASSERT_NE(fd.newValue, nullptr);
+    }
+
+    /* Change one field */
+    p.hset(key, "oper_status", "up");
+    int ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    c.popsDelta(deltas);
+    ASSERT_EQ(deltas.size(), 1U);
+    ASSERT_EQ(deltas[0].fields.size(), 1U);
+    EXPECT_EQ(deltas[0].fields[0].field, "oper_status");
+    ASSERT_NE(deltas[0].fields[0].oldValue, nullptr);
+    ASSERT_NE(deltas[0].fields[0].newValue, nullptr);
+    EXPECT_EQ(*deltas[0].fields[0].oldValue, "down");
+    EXPECT_EQ(*deltas[0].fields[0].newValue, "up");
+
+    /* Remove one field */
+    p.hdel(key, "admin_status");
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    c.popsDelta(deltas);
+    ASSERT_EQ(deltas.size(), 1U);
+    ASSERT_EQ(deltas[0].fields.size(), 1U);
+    EXPECT_EQ(deltas[0].fields[0].field, "admin_status");
+    ASSERT_NE(deltas[0].fields[0].oldValue, nullptr);
+    EXPECT_EQ(*deltas[0].fields[0].oldValue, "up");
+    EXPECT_EQ(deltas[0].fields[0].newValue, nullptr);
+
+    /* Delete the entry, the remaining field is reported as removed */
+    p.del(key);
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    c.popsDelta(deltas);
+    ASSERT_EQ(deltas.size(), 1U);
+    EXPECT_EQ(deltas[0].op, "DEL");
+    ASSERT_EQ(deltas[0].fields.size(), 1U);
+    EXPECT_EQ(deltas[0].fields[0].field, "oper_status");
+    EXPECT_EQ(deltas[0].fields[0].newValue, nullptr);
+}
+
+TEST(SubscriberStateTable, keyspace_dispatcher)
+{
+    clearDB();
+
+    /* Prepare producers */
+    DBConnector db("TEST_DB", 0, true);
+    Table p1(&db, testTableName);
+    Table p2(&db, testTableName2);
+
+    /* Prepare subscribers sharing one keyspace subscription */
+    KeyspaceDispatcher dispatcher(&db);
+    SubscriberStateTable c1(&db, testTableName, dispatcher);
+    SubscriberStateTable c2(&db, testTableName2, dispatcher);
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&dispatcher);
+    cs.addSelectable(&c1);
+    cs.addSelectable(&c2);
+
+    p1.set("key1", vector<FieldValueTuple>{{"field", "value1"}});
+    p2.set("key2", vector<FieldValueTuple>{{"field", "value2"}});
+
+    map<Selectable *, KeyOpFieldsValuesTuple> received;
+    while (received.size() < 2)
+    {
+        int ret = cs.select(&selectcs, 1000);
+        ASSERT_EQ(ret, Select::OBJECT);
+        ASSERT_NE(selectcs, &dispatcher);
+
+        std::deque<KeyOpFieldsValuesTuple> vkco;
+        ((SubscriberStateTable *)selectcs)->pops(vkco);
+        for (auto &kco : vkco)
+        {
+            received[selectcs] = kco;
+        }
+    }
+
+    EXPECT_EQ(kfvKey(received[&c1]), "key1");
+    EXPECT_EQ(kfvOp(received[&c1]), "SET");
+    EXPECT_EQ(fvValue(kfvFieldsValues(received[&c1])[0]), "value1");
+    EXPECT_EQ(kfvKey(received[&c2]), "key2");
+    EXPECT_EQ(kfvOp(received[&c2]), "SET");
+    EXPECT_EQ(fvValue(kfvFieldsValues(received[&c2])[0]), "value2");
+
+    /* Nothing left, the dispatcher itself is never reported */
+    int ret = cs.select(&selectcs, 100);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+}
+
+TEST(SubscriberStateTable, keyspace_dispatcher_destroyed_first)
+{
+    clearDB();
+
+    DBConnector db("TEST_DB", 0, true);
+    auto dispatcher = make_unique<KeyspaceDispatcher>(&db);
+    SubscriberStateTable c(&db, testTableName, *dispatcher);
+
+    /* The table is detached and outlives the dispatcher safely */
+    dispatcher.reset();
+    EXPECT_EQ(c.m_dispatcher, nullptr);
+
+    std::deque<KeyOpFieldsValuesTuple> vkco;
+    c.pops(vkco);
+    EXPECT_TRUE(vkco.empty());
+}
@@ -1,3 +1,5 @@
+#include <set>
+#include <thread>
 #include "common/dbconnector.h"
 #include "common/consumertable.h"
 #include "common/notificationconsumer.h"
@@ -247,3 +249,236 @@ TEST(Priority, priority_select_6)
     // we gave fair scheduler. we've read different selectables on the second read
     EXPECT_NE(selectcs1, selectcs2);
 }
+
+TEST(Priority, priority_select_many)
+{
+    Select cs;
+    vector<Selectable *> selected;
+
+    SelectableEvent s1(100);
+    SelectableEvent s2(1000);
+    SelectableEvent s3(10000);
+
+    cs.addSelectable(&s1);
+    cs.addSelectable(&s2);
+    cs.addSelectable(&s3);
+
+    s1.notify();
+    s3.notify();
+
+    int ret;
+    ret = cs.selectMany(selected);
+    EXPECT_EQ(ret, Select::OBJECT);
+    ASSERT_EQ(selected.size(), 2U);
+    EXPECT_EQ(selected[0], &s3);
+    EXPECT_EQ(selected[1], &s1);
+
+    s2.notify();
+
+    ret = cs.selectMany(selected);
+    EXPECT_EQ(ret, Select::OBJECT);
+    ASSERT_EQ(selected.size(), 1U);
+    EXPECT_EQ(selected[0], &s2);
+
+    ret = cs.selectMany(selected, 100);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+    EXPECT_TRUE(selected.empty());
+}
+
+TEST(Priority, priority_select_round_robin)
+{
+    Select cs;
+    Selectable *selectcs;
+
+    SelectableEvent s1(1000);
+    SelectableEvent s2(1000);
+    SelectableEvent s3(1000);
+    SelectableEvent s4(10);
+
+    cs.addSelectable(&s1);
+    cs.addSelectable(&s2);
+    cs.addSelectable(&s3);
+    cs.addSelectable(&s4);
+
+    s1.notify();
+    s2.notify();
+    s3.notify();
+    s4.notify();
+
+    int ret;
+    set<Selectable *> selected;
+    for (int i = 0; i < 3; i++)
+    {
+        ret = cs.select(&selectcs);
+        EXPECT_EQ(ret, Select::OBJECT);
+        EXPECT_NE(selectcs, &s4);
+        selected.insert(selectcs);
+
+        // a selectable signaled again waits behind its ready peers
+        ((SelectableEvent *)selectcs)->notify();
+    }
+    EXPECT_EQ(selected.size(), 3U);
+
+    // remove a ready selectable, it must not be returned anymore
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    Selectable *removed = selectcs == &s1 ? &s2 : &s1;
+    cs.removeSelectable(removed);
+
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_NE(selectcs, removed);
+    EXPECT_NE(selectcs, &s4);
+
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s4);
+    EXPECT_TRUE(cs.isQueueEmpty());
+}
+
+TEST(Priority, edge_triggered)
+{
+    Select cs;
+    Selectable *selectcs;
+
+    SelectableEvent s1(100);
+    SelectableEvent s2(1000);
+
+    cs.addSelectable(&s1, true);
+    cs.addSelectable(&s2);
+
+    s1.notify();
+    s2.notify();
+
+    int ret;
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s2);
+
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s1);
+
+    ret = cs.select(&selectcs, 100);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+
+    // a new event is reported again
+    s1.notify();
+    ret = cs.select(&selectcs, 100);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s1);
+}
+
+class MutablePriorityEvent : public SelectableEvent
+{
+public:
+    MutablePriorityEvent(int pri) : SelectableEvent(pri), m_pri(pri) {}
+
+    int getPri() const override
+    {
+        return m_pri;
+    }
+
+    int m_pri;
+};
+
+TEST(Priority, remove_after_priority_change)
+{
+    Select cs;
+    Selectable *selectcs;
+
+    MutablePriorityEvent s1(100);
+    SelectableEvent s2(200);
+    SelectableEvent s3(100);
+
+    cs.addSelectable(&s1);
+    cs.addSelectable(&s2);
+    cs.addSelectable(&s3);
+
+    // the bucket of the priority s1 was added with is the one to release
+    s1.m_pri = 200;
+    cs.removeSelectable(&s1);
+
+    s2.notify();
+    s3.notify();
+
+    int ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s2);
+
+    ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s3);
+}
+
+TEST(Priority, busy_poll)
+{
+    Select cs;
+    Selectable *selectcs;
+
+    SelectableEvent s1;
+    cs.addSelectable(&s1);
+    cs.setBusyPollWindow(2000);
+
+    // the event arrives while select is spinning
+    std::thread notifier([&s1]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        s1.notify();
+    });
+
+    int ret = cs.select(&selectcs, 1000);
+    notifier.join();
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s1);
+
+    // spinning without events shrinks the window
+    ret = cs.select(&selectcs, 10);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+    EXPECT_LT(cs.m_busyPollWindow.count(), 2000);
+}
+
+TEST(Priority, profiling)
+{
+    Select cs;
+    Selectable *selectcs;
+
+    SelectableEvent s1(100);
+    SelectableEvent s2(1000);
+
+    cs.addSelectable(&s1);
+    cs.addSelectable(&s2);
+    cs.enableProfiling(true);
+
+    for (int i = 0; i < 3; i++)
+    {
+        s1.notify();
+        int ret = cs.select(&selectcs);
+        EXPECT_EQ(ret, Select::OBJECT);
+        EXPECT_EQ(selectcs, &s1);
+
+        // slow handler
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    s2.notify();
+    int ret = cs.select(&selectcs);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(selectcs, &s2);
+
+    ret = cs.select(&selectcs, 10);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+
+    auto top = cs.getTopHandlers(1);
+    ASSERT_EQ(top.size(), 1U);
+    EXPECT_EQ(top[0].selectable, &s1);
+    EXPECT_EQ(top[0].dispatchCount, 3U);
+    EXPECT_EQ(top[0].handlerTime.samples, 3U);
+    EXPECT_GE(top[0].handlerTime.maxUs, 20000U);
+    EXPECT_NE(top[0].name.find("SelectableEvent"), string::npos);
+
+    auto profiles = cs.getProfile();
+    EXPECT_EQ(profiles.size(), 2U);
+
+    cs.resetProfile();
+    EXPECT_TRUE(cs.getProfile().empty());
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "common/select.h"
+#include "common/selectablequeue.h"
+
+using namespace std;
+using namespace swss;
+
+TEST(SelectableQueue, push_pop)
+{
+    SelectableQueue<string> queue(3);
+    EXPECT_EQ(queue.capacity(), 4U);
+    EXPECT_TRUE(queue.empty());
+
+    EXPECT_TRUE(queue.push("a"));
+    EXPECT_TRUE(queue.push("b"));
+    EXPECT_TRUE(queue.push("c"));
+    EXPECT_TRUE(queue.push("d"));
+    EXPECT_FALSE(queue.push("e"));
+
+    string item;
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, "a");
+
+    // room again after a pop
+    EXPECT_TRUE(queue.push("e"));
+
+    vector<string> items;
+    queue.pops(items, 2);
+    EXPECT_EQ(items, vector<string>({"b", "c"}));
+    queue.pops(items);
+    EXPECT_EQ(items, vector<string>({"d", "e"}));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(SelectableQueue, batched_notify)
+{
+    SelectableQueue<int> queue;
+    Select s;
+    Selectable *sel;
+    s.addSelectable(&queue);
+
+    for (int i = 0; i < 100; i++)
+    {
+        queue.push(i);
+    }
+
+    int ret = s.select(&sel, 1000);
+    EXPECT_EQ(ret, Select::OBJECT);
+    EXPECT_EQ(sel, &queue);
+
+    vector<int> items;
+    queue.pops(items);
+    EXPECT_EQ(items.size(), 100U);
+
+    // the burst caused a single wakeup
+    ret = s.select(&sel, 10);
+    EXPECT_EQ(ret, Select::TIMEOUT);
+
+    queue.push(100);
+    ret = s.select(&sel, 1000);
+    EXPECT_EQ(ret, Select::OBJECT);
+    queue.pops(items);
+    EXPECT_EQ(items, vector<int>({100}));
+}
+
+TEST(SelectableQueue, multiple_producers)
+{
+    const int producers = 4;
+    const int count = 20000;
+
+    SelectableQueue<pair<int, int>> queue(256);
+    Select s;
+    Selectable *sel;
+    s.addSelectable(&queue);
+
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&queue, p, count]() {
+            for (int i = 0; i < count; i++)
+            {
+                while (!queue.push(make_pair(p, i)))
+                {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+
+    vector<int> next(producers, 0);
+    int received = 0;
+    vector<pair<int, int>> items;
+    while (received < producers * count)
+    {
+        int ret = s.select(&sel, 5000);
+        ASSERT_EQ(ret, Select::OBJECT);
+
+        queue.pops(items, 64);
+        for (auto &item : items)
+        {
+            // every producer's items arrive in order
+            EXPECT_EQ(item.second, next[item.first]);
+            next[item.first] = item.second + 1;
+        }
+        received += static_cast<int>(items.size());
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,94 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "gtest/gtest.h"
+#include "common/shmring.h"
+
+using namespace std;
+using namespace swss;
+
+TEST(ShmRing, write_read_wrap)
+{
+    ShmRing consumer(256);
+    ShmRing producer(dup(consumer.getMemFd()), dup(consumer.getEventFd()));
+    EXPECT_EQ(producer.getMaxMessageSize(), 120U);
+
+    const char *data;
+    size_t length;
+    EXPECT_FALSE(consumer.read(data, length));
+
+    // go around the ring a few times, messages never wrap
+    for (int i = 0; i < 20; i++)
+    {
+        string first(50 + i, (char)('a' + i));
+        string second(30, (char)('A' + i));
+        EXPECT_TRUE(producer.write(first.data(), first.length()));
+        EXPECT_TRUE(producer.write(second.data(), second.length()));
+
+        ASSERT_TRUE(consumer.read(data, length));
+        EXPECT_EQ(string(data, length), first);
+        consumer.release();
+        ASSERT_TRUE(consumer.read(data, length));
+        EXPECT_EQ(string(data, length), second);
+        consumer.release();
+        EXPECT_FALSE(consumer.read(data, length));
+    }
+
+    // full ring
+    string big(producer.getMaxMessageSize(), 'x');
+    EXPECT_TRUE(producer.write(big.data(), big.length()));
+    EXPECT_FALSE(producer.write(big.data(), big.length()));
+    EXPECT_THROW(producer.write(big.data(), big.length() + 1), runtime_error);
+}
+
+TEST(ShmRing, wakeup)
+{
+    ShmRing consumer(4096);
+    ShmRing producer(dup(consumer.getMemFd()), dup(consumer.getEventFd()));
+
+    // no wakeup is written while the consumer doesn't wait
+    EXPECT_TRUE(producer.write("a", 1));
+    uint64_t value;
+    EXPECT_EQ(read(consumer.getEventFd(), &value, sizeof(value)), -1);
+    EXPECT_FALSE(consumer.prepareWait());
+
+    const char *data;
+    size_t length;
+    ASSERT_TRUE(consumer.read(data, length));
+    consumer.release();
+
+    EXPECT_TRUE(consumer.prepareWait());
+    EXPECT_TRUE(producer.write("b", 1));
+    EXPECT_EQ(read(consumer.getEventFd(), &value, sizeof(value)), (ssize_t)sizeof(value));
+}
+
+TEST(ShmRing, fd_passing)
+{
+    const string endpoint = "shm://shmring_ut";
+    int listenFd = ShmRing::listen(endpoint);
+
+    ShmRing consumer(4096);
+    thread server([&]() {
+        int fd = accept(listenFd, NULL, NULL);
+        ShmRing::sendFds(fd, consumer.getMemFd(), consumer.getEventFd());
+        close(fd);
+    });
+
+    int socket = ShmRing::connect(endpoint);
+    int memfd;
+    int eventfd;
+    ShmRing::receiveFds(socket, memfd, eventfd);
+    server.join();
+    close(socket);
+    close(listenFd);
+
+    ShmRing producer(memfd, eventfd);
+    EXPECT_TRUE(producer.write("hello", 5));
+
+    const char *data;
+    size_t length;
+    ASSERT_TRUE(consumer.read(data, length));
+    EXPECT_EQ(string(data, length), "hello");
+}
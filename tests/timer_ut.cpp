@@ -1,5 +1,8 @@
+#include <memory>
+#include <mutex>
 #include "common/select.h"
 #include "common/selectabletimer.h"
+#include "common/timerwheel.h"
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -50,3 +53,98 @@ TEST(TIMER, selectabletimer)
     ASSERT_EQ(result, Select::OBJECT);
     ASSERT_EQ(sel, &timer);
 }
+
+TEST(TIMER, timerwheel)
+{
+    timespec tick = { .tv_sec = 0, .tv_nsec = 10000000 };
+    TimerWheel wheel(tick);
+
+    timespec interval = { .tv_sec = 0, .tv_nsec = 50000000 };
+    WheelTimer timer1(wheel, interval);
+    WheelTimer timer2(wheel, interval);
+
+    Select s;
+    s.addSelectable(&wheel);
+    Selectable *sel;
+    int result;
+    vector<WheelTimer *> expired;
+
+    // Wait non started timers
+    result = s.select(&sel, 200);
+    ASSERT_EQ(result, Select::TIMEOUT);
+
+    timer1.start();
+    timer2.start();
+    EXPECT_EQ(wheel.getTimerCount(), 2U);
+
+    result = s.select(&sel, 2000);
+    ASSERT_EQ(result, Select::OBJECT);
+    ASSERT_EQ(sel, &wheel);
+    wheel.pops(expired);
+    EXPECT_EQ(expired.size(), 2U);
+
+    // Stopped timers don't fire anymore
+    timer1.stop();
+    timer2.stop();
+    EXPECT_EQ(wheel.getTimerCount(), 0U);
+    result = s.select(&sel, 200);
+    ASSERT_EQ(result, Select::TIMEOUT);
+
+    // Only the running timer fires
+    timer2.start();
+    result = s.select(&sel, 2000);
+    ASSERT_EQ(result, Select::OBJECT);
+    wheel.pops(expired);
+    ASSERT_EQ(expired.size(), 1U);
+    EXPECT_EQ(expired[0], &timer2);
+}
+
+TEST(TIMER, timerwheel_cascade)
+{
+    timespec tick = { .tv_sec = 0, .tv_nsec = 1000000 };
+    TimerWheel wheel(tick);
+
+    // intervals in ticks, covering every level of the wheel
+    vector<uint64_t> ticks = { 1, 3, 255, 256, 257, 300, 16383, 16384, 20000, 1048577, 3000000 };
+    vector<unique_ptr<WheelTimer>> timers;
+    for (auto t : ticks)
+    {
+        timespec interval = { .tv_sec = static_cast<time_t>(t / 1000), .tv_nsec = static_cast<long>((t % 1000) * 1000000) };
+        timers.emplace_back(new WheelTimer(wheel, interval));
+        timers.back()->start();
+    }
+
+    // drive the wheel by hand and check the first expiry of every timer
+    vector<uint64_t> fired(ticks.size(), 0);
+    vector<WheelTimer *> expired;
+    uint64_t last = ticks.back();
+    for (uint64_t now = 1; now <= last; now++)
+    {
+        {
+            lock_guard<mutex> lock(wheel.m_mutex);
+            wheel.advance();
+        }
+
+        if (!wheel.hasData())
+        {
+            continue;
+        }
+
+        wheel.pops(expired);
+        for (auto timer : expired)
+        {
+            for (size_t i = 0; i < timers.size(); i++)
+            {
+                if (timers[i].get() == timer && fired[i] == 0)
+                {
+                    fired[i] = now;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ticks.size(); i++)
+    {
+        EXPECT_EQ(fired[i], ticks[i]) << "interval " << ticks[i];
+    }
+}
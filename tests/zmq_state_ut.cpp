@@ -438,3 +438,557 @@ TEST(ZmqConsumerStateTableBatchBufferOverflow, test)
     }
     EXPECT_ANY_THROW(p.send(kcos));
 }
+
+class ZmqRecordingHandler : public ZmqMessageHandler
+{
+public:
+    ZmqRecordingHandler(int delayMs)
+        : m_delayMs(delayMs)
+    {
+    }
+
+    void handleReceivedData(const std::vector<std::shared_ptr<KeyOpFieldsValuesTuple>>& kcos) override
+    {
+        this_thread::sleep_for(chrono::milliseconds(m_delayMs));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& kco : kcos)
+        {
+            m_keys.push_back(kfvKey(*kco));
+            m_kcos.push_back(*kco);
+        }
+        m_messageCount++;
+    }
+
+    vector<string> getKeys()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_keys;
+    }
+
+    vector<KeyOpFieldsValuesTuple> getKcos()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_kcos;
+    }
+
+    int getMessageCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messageCount;
+    }
+
+    void handleSequenceGap(uint64_t, uint64_t lostCount) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lostCount += lostCount;
+    }
+
+    uint64_t getLostCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lostCount;
+    }
+
+private:
+    int m_delayMs;
+    std::mutex m_mutex;
+    vector<string> m_keys;
+    vector<KeyOpFieldsValuesTuple> m_kcos;
+    int m_messageCount = 0;
+    uint64_t m_lostCount = 0;
+};
+
+TEST(ZmqServer, decode_threads)
+{
+    std::string pushEndpoint = "tcp://localhost:1235";
+    std::string pullEndpoint = "tcp://*:1235";
+    const int count = 100;
+
+    ZmqServer server(pullEndpoint, 2);
+    ZmqRecordingHandler slow(5);
+    ZmqRecordingHandler fast(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_SLOW_UT", &slow);
+    server.registerMessageHandler(TEST_DB, "ZMQ_FAST_UT", &fast);
+
+    ZmqClient client(pushEndpoint);
+    vector<string> expected;
+    for (int i = 0; i < count; i++)
+    {
+        auto key = "key_" + to_string(i);
+        expected.push_back(key);
+
+        vector<KeyOpFieldsValuesTuple> kcos{KeyOpFieldsValuesTuple(key, DEL_COMMAND, vector<FieldValueTuple>{})};
+        client.sendMsg(TEST_DB, "ZMQ_SLOW_UT", kcos);
+        client.sendMsg(TEST_DB, "ZMQ_FAST_UT", kcos);
+    }
+
+    for (int i = 0; i < 1000 && fast.getKeys().size() < count; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // the slow handler doesn't hold back the other table
+    EXPECT_EQ(fast.getKeys(), expected);
+    EXPECT_LT(slow.getKeys().size(), (size_t)count);
+
+    for (int i = 0; i < 1000 && slow.getKeys().size() < count; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+
+    // every table keeps its order
+    EXPECT_EQ(slow.getKeys(), expected);
+}
+
+TEST(ZmqClient, async_send)
+{
+    std::string pushEndpoint = "tcp://localhost:1236";
+    std::string pullEndpoint = "tcp://*:1236";
+    const int count = 1000;
+
+    ZmqServer server(pullEndpoint);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_ASYNC_UT", &handler);
+
+    ZmqClient client(pushEndpoint);
+    size_t backPressureDepth = 0;
+    client.enableAsyncSend(16, [&backPressureDepth](size_t depth) { backPressureDepth = depth; });
+
+    vector<string> expected;
+    for (int i = 0; i < count; i++)
+    {
+        auto key = "key_" + to_string(i);
+        expected.push_back(key);
+
+        vector<KeyOpFieldsValuesTuple> kcos{KeyOpFieldsValuesTuple(key, DEL_COMMAND, vector<FieldValueTuple>{})};
+        client.sendMsg(TEST_DB, "ZMQ_ASYNC_UT", kcos);
+    }
+
+    client.flush();
+    EXPECT_EQ(client.getQueueDepth(), 0U);
+    EXPECT_GT(client.getQueueHighWatermark(), 0U);
+    if (client.getBackPressureCount() > 0)
+    {
+        EXPECT_GT(backPressureDepth, 16U);
+    }
+
+    for (int i = 0; i < 1000 && handler.getKeys().size() < count; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // batches may be merged, but arrive complete and in order
+    EXPECT_EQ(handler.getKeys(), expected);
+
+    // too big messages still fail on the caller
+    vector<KeyOpFieldsValuesTuple> big{KeyOpFieldsValuesTuple("key", SET_COMMAND, vector<FieldValueTuple>{{"field", string(MQ_RESPONSE_MAX_COUNT, 'x')}})};
+    EXPECT_THROW(client.sendMsg(TEST_DB, "ZMQ_ASYNC_UT", big), runtime_error);
+}
+
+TEST(ZmqProducerStateTable, batching)
+{
+    std::string pushEndpoint = "tcp://localhost:1237";
+    std::string pullEndpoint = "tcp://*:1237";
+
+    ZmqServer server(pullEndpoint);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_BATCH_UT", &handler);
+
+    DBConnector db(TEST_DB, 0, true);
+    ZmqClient client(pushEndpoint);
+    ZmqProducerStateTable p(&db, "ZMQ_BATCH_UT", client, false);
+
+    // a linger long enough to flush by hand
+    p.setBatching(100, MQ_BATCH_MAX_BYTES, 10000000);
+    p.set("a", vector<FieldValueTuple>{{"f1", "1"}, {"f2", "1"}});
+    p.set("b", vector<FieldValueTuple>{{"f1", "1"}});
+    p.set("a", vector<FieldValueTuple>{{"f2", "2"}, {"f3", "2"}});
+    p.del("b");
+    p.set("b", vector<FieldValueTuple>{{"f1", "2"}});
+    EXPECT_EQ(p.getPendingCount(), 3U);
+
+    p.flush();
+    EXPECT_EQ(p.getPendingCount(), 0U);
+    for (int i = 0; i < 1000 && handler.getMessageCount() < 1; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    vector<KeyOpFieldsValuesTuple> expected{
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}, {"f2", "2"}, {"f3", "2"}}},
+        KeyOpFieldsValuesTuple{"b", DEL_COMMAND, vector<FieldValueTuple>{}},
+        KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f1", "2"}}}};
+    EXPECT_EQ(handler.getMessageCount(), 1);
+    EXPECT_EQ(handler.getKcos(), expected);
+
+    // the count threshold sends right away
+    p.setBatching(2, MQ_BATCH_MAX_BYTES, 10000000);
+    p.set("c", vector<FieldValueTuple>{{"f1", "1"}});
+    p.set("d", vector<FieldValueTuple>{{"f1", "1"}});
+    EXPECT_EQ(p.getPendingCount(), 0U);
+
+    // the linger sends a partial batch
+    p.setBatching(100, MQ_BATCH_MAX_BYTES, 1000);
+    p.del("e");
+    for (int i = 0; i < 1000 && handler.getMessageCount() < 3; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(handler.getMessageCount(), 3);
+    EXPECT_EQ(handler.getKeys(), vector<string>({"a", "b", "b", "c", "d", "e"}));
+
+    // a re-set key keeps its position before the keys that refer to it, and
+    // only the live bytes count towards the byte threshold
+    p.setBatching(100, 64, 10000000);
+    p.set("x", vector<FieldValueTuple>{{"f", "0"}});
+    p.set("y", vector<FieldValueTuple>{{"ref", "x"}});
+    for (int i = 0; i < 20; i++)
+    {
+        p.set("x", vector<FieldValueTuple>{{"f", to_string(i % 10)}});
+    }
+    EXPECT_EQ(p.getPendingCount(), 2U);
+
+    p.flush();
+    for (int i = 0; i < 1000 && handler.getMessageCount() < 4; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(handler.getMessageCount(), 4);
+    EXPECT_EQ(handler.getKeys(), vector<string>({"a", "b", "b", "c", "d", "e", "x", "y"}));
+}
+
+TEST(ZmqConsumerStateTable, coalesce)
+{
+    std::string pullEndpoint = "tcp://*:1238";
+
+    DBConnector db(TEST_DB, 0, true);
+    ZmqServer server(pullEndpoint);
+    ZmqConsumerStateTable c(&db, "ZMQ_COALESCE_UT", server, 128, 0, false, true);
+
+    vector<KeyOpFieldsValuesEntry> entries;
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}, {"f2", "1"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"c", DEL_COMMAND, vector<FieldValueTuple>{}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f2", "2"}, {"f3", "2"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"b", DEL_COMMAND, vector<FieldValueTuple>{}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f2", "2"}}});
+    c.handleReceivedEntries(entries);
+
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&c);
+    ASSERT_EQ(cs.select(&selectcs, 1000), Select::OBJECT);
+
+    std::deque<KeyOpFieldsValuesTuple> vkco;
+    c.pops(vkco);
+
+    // one slot per key in the order of first arrival
+    std::deque<KeyOpFieldsValuesTuple> expected{
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}, {"f2", "2"}, {"f3", "2"}}},
+        KeyOpFieldsValuesTuple{"b", DEL_COMMAND, vector<FieldValueTuple>{}},
+        KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f2", "2"}}},
+        KeyOpFieldsValuesTuple{"c", DEL_COMMAND, vector<FieldValueTuple>{}}};
+    EXPECT_EQ(vkco, expected);
+    EXPECT_FALSE(c.hasData());
+
+    // an op other than SET and DEL is neither merged nor dropped
+    entries.clear();
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", "FLUSH", vector<FieldValueTuple>{{"f1", "2"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f2", "3"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f3", "4"}}});
+    c.handleReceivedEntries(entries);
+    ASSERT_EQ(cs.select(&selectcs, 1000), Select::OBJECT);
+    c.pops(vkco);
+
+    expected = std::deque<KeyOpFieldsValuesTuple>{
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}},
+        KeyOpFieldsValuesTuple{"a", "FLUSH", vector<FieldValueTuple>{{"f1", "2"}}},
+        KeyOpFieldsValuesTuple{"b", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}},
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f2", "3"}, {"f3", "4"}}}};
+    EXPECT_EQ(vkco, expected);
+}
+
+TEST(ZmqServer, shm_transport)
+{
+    std::string endpoint = "shm://zmq_state_ut";
+    const int count = 1000;
+
+    // the client connects on the first send when the server is not up yet
+    ZmqClient client(endpoint);
+    EXPECT_FALSE(client.isConnected());
+
+    ZmqServer server(endpoint, 1);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_SHM_UT", &handler);
+
+    DBConnector db(TEST_DB, 0, true);
+    ZmqProducerStateTable p(&db, "ZMQ_SHM_UT", client, false);
+
+    vector<string> expected;
+    for (int i = 0; i < count; i++)
+    {
+        auto key = "key_" + to_string(i);
+        expected.push_back(key);
+        p.set(key, vector<FieldValueTuple>{{"field", "value"}});
+    }
+
+    EXPECT_TRUE(client.isConnected());
+    for (int i = 0; i < 1000 && handler.getKeys().size() < count; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(handler.getKeys(), expected);
+}
+
+TEST(ZmqServer, sequence_gap)
+{
+    std::string pushEndpoint = "tcp://localhost:1239";
+    std::string pullEndpoint = "tcp://*:1239";
+
+    ZmqServer server(pullEndpoint);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_SEQUENCE_UT", &handler);
+
+    ZmqClient client(pushEndpoint);
+    client.enableSequenceNumbers();
+
+    // a client without numbers talks to the same server
+    ZmqClient legacy(pushEndpoint);
+
+    auto send = [](ZmqClient& c, const string& key) {
+        vector<KeyOpFieldsValuesTuple> kcos{KeyOpFieldsValuesTuple(key, DEL_COMMAND, vector<FieldValueTuple>{})};
+        c.sendMsg(TEST_DB, "ZMQ_SEQUENCE_UT", kcos);
+    };
+
+    send(client, "a");
+    send(client, "b");
+    send(legacy, "c");
+
+    // two messages are lost on the way
+    client.m_sequences[string(TEST_DB) + ":ZMQ_SEQUENCE_UT"] += 2;
+    send(client, "d");
+
+    for (int i = 0; i < 1000 && handler.getKeys().size() < 4; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(handler.getKeys(), vector<string>({"a", "b", "c", "d"}));
+    EXPECT_EQ(handler.getLostCount(), 2U);
+
+    // a producer whose first messages were lost, e.g. sent before the server started
+    ZmqClient late(pushEndpoint);
+    late.enableSequenceNumbers();
+    late.m_sequences[string(TEST_DB) + ":ZMQ_SEQUENCE_UT"] = 3;
+    send(late, "e");
+
+    for (int i = 0; i < 1000 && handler.getKeys().size() < 5; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(handler.getLostCount(), 5U);
+}
+
+TEST(ZmqServer, sequence_producer_limit)
+{
+    ZmqServer server("tcp://*:1245");
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_SEQUENCE_LIMIT_UT", &handler);
+    auto& state = *server.m_handlers[0];
+
+    // restarted producers come with new ids, the silent ones are dropped
+    for (uint64_t id = 1; id <= 2 * MQ_SEQUENCE_MAX_PRODUCERS; id++)
+    {
+        server.checkSequence(state, 0, id);
+        server.checkSequence(state, id, 1);
+    }
+
+    EXPECT_EQ(state.producers.size(), (size_t)MQ_SEQUENCE_MAX_PRODUCERS);
+    EXPECT_EQ(state.producers.count(0), 1U);
+    EXPECT_EQ(state.producers.count(2 * MQ_SEQUENCE_MAX_PRODUCERS), 1U);
+    EXPECT_EQ(handler.getLostCount(), 0U);
+}
+
+static void testResync(const std::string& port, bool coalesce)
+{
+    std::string pullEndpoint = "tcp://*:" + port;
+
+    DBConnector db(TEST_DB, 0, true);
+    Table table(&db, "ZMQ_RESYNC_UT");
+    table.set("a", vector<FieldValueTuple>{{"f1", "1"}});
+
+    ZmqServer server(pullEndpoint);
+    ZmqConsumerStateTable c(&db, "ZMQ_RESYNC_UT", server, 128, 0, false, coalesce);
+
+    vector<KeyOpFieldsValuesEntry> entries;
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "0"}}});
+    entries.emplace_back(KeyOpFieldsValuesTuple{"b", DEL_COMMAND, vector<FieldValueTuple>{}});
+    c.handleReceivedEntries(entries);
+    c.handleSequenceGap(1, 1);
+
+    // updated after the gap, the DB still holds the older value
+    entries.clear();
+    entries.emplace_back(KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "2"}}});
+    c.handleReceivedEntries(entries);
+
+    Select cs;
+    Selectable *selectcs;
+    cs.addSelectable(&c);
+    ASSERT_EQ(cs.select(&selectcs, 1000), Select::OBJECT);
+
+    // the entries before the gap, the table reloaded from the DB, then the entries after the gap
+    std::deque<KeyOpFieldsValuesTuple> vkco;
+    c.pops(vkco);
+    std::deque<KeyOpFieldsValuesTuple> expected{
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "0"}}},
+        KeyOpFieldsValuesTuple{"b", DEL_COMMAND, vector<FieldValueTuple>{}},
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "1"}}},
+        KeyOpFieldsValuesTuple{"a", SET_COMMAND, vector<FieldValueTuple>{{"f1", "2"}}}};
+    EXPECT_EQ(vkco, expected);
+    EXPECT_EQ(c.getResyncCount(), 1U);
+    EXPECT_FALSE(c.hasData());
+
+    table.del("a");
+}
+
+TEST(ZmqConsumerStateTable, resync)
+{
+    testResync("1240", false);
+}
+
+TEST(ZmqConsumerStateTable, resync_coalesce)
+{
+    testResync("1246", true);
+}
+
+TEST(ZmqClient, compression)
+{
+    std::string pushEndpoint = "tcp://localhost:1241";
+    std::string pullEndpoint = "tcp://*:1241";
+
+    ZmqServer server(pullEndpoint, 1);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_COMPRESS_UT", &handler);
+
+    ZmqClient client(pushEndpoint);
+    client.enableCompression();
+
+    vector<KeyOpFieldsValuesTuple> small{KeyOpFieldsValuesTuple("small", DEL_COMMAND, vector<FieldValueTuple>{})};
+    client.sendMsg(TEST_DB, "ZMQ_COMPRESS_UT", small);
+
+    vector<KeyOpFieldsValuesTuple> routes;
+    for (int i = 0; i < 1000; i++)
+    {
+        routes.push_back(KeyOpFieldsValuesTuple("10.0." + to_string(i / 256) + "." + to_string(i % 256) + "/32", SET_COMMAND,
+            vector<FieldValueTuple>{{"nexthop", "10.1.0.1,10.1.0.3"}, {"ifname", "Ethernet0,Ethernet4"}}));
+    }
+    client.sendMsg(TEST_DB, "ZMQ_COMPRESS_UT", routes);
+
+    // bigger than a message before compression
+    vector<KeyOpFieldsValuesTuple> big{KeyOpFieldsValuesTuple("big", SET_COMMAND, vector<FieldValueTuple>{{"field", string(MQ_RESPONSE_MAX_COUNT, 'x')}})};
+    client.sendMsg(TEST_DB, "ZMQ_COMPRESS_UT", big);
+
+    for (int i = 0; i < 1000 && handler.getMessageCount() < 3; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    auto received = handler.getKcos();
+    ASSERT_EQ(received.size(), 1002U);
+    EXPECT_EQ(received[0], small[0]);
+    EXPECT_EQ(vector<KeyOpFieldsValuesTuple>(received.begin() + 1, received.begin() + 1001), routes);
+    EXPECT_EQ(received[1001], big[0]);
+}
+
+TEST(ZmqClient, compact_wire_format)
+{
+    std::string pushEndpoint = "tcp://localhost:1244";
+    std::string pullEndpoint = "tcp://*:1244";
+
+    ZmqServer server(pullEndpoint);
+    ZmqRecordingHandler handler(0);
+    server.registerMessageHandler(TEST_DB, "ZMQ_WIRE_V2_UT", &handler);
+
+    ZmqClient client(pushEndpoint);
+    client.enableCompactWireFormat();
+    client.enableCompression();
+
+    vector<KeyOpFieldsValuesTuple> small{
+        KeyOpFieldsValuesTuple("small", SET_COMMAND, vector<FieldValueTuple>{{"field", "value"}}),
+        KeyOpFieldsValuesTuple("small", DEL_COMMAND, vector<FieldValueTuple>{})};
+    client.sendMsg(TEST_DB, "ZMQ_WIRE_V2_UT", small);
+
+    // compressed on top of the compact format
+    vector<KeyOpFieldsValuesTuple> routes;
+    for (int i = 0; i < 1000; i++)
+    {
+        routes.push_back(KeyOpFieldsValuesTuple("10.0." + to_string(i / 256) + "." + to_string(i % 256) + "/32", SET_COMMAND,
+            vector<FieldValueTuple>{{"nexthop", "10.1.0.1,10.1.0.3"}, {"ifname", "Ethernet0,Ethernet4"}}));
+    }
+    client.sendMsg(TEST_DB, "ZMQ_WIRE_V2_UT", routes);
+
+    for (int i = 0; i < 1000 && handler.getMessageCount() < 2; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    auto received = handler.getKcos();
+    ASSERT_EQ(received.size(), 1002U);
+    EXPECT_EQ(vector<KeyOpFieldsValuesTuple>(received.begin(), received.begin() + 2), small);
+    EXPECT_EQ(vector<KeyOpFieldsValuesTuple>(received.begin() + 2, received.end()), routes);
+}
+
+static void testAcks(const std::string& port, size_t decodeThreadCount)
+{
+    std::string pushEndpoint = "tcp://localhost:" + port;
+    std::string pullEndpoint = "tcp://*:" + port;
+    const int count = 100;
+
+    ZmqServer server(pullEndpoint, decodeThreadCount, true);
+    ZmqRecordingHandler handler(1);
+    server.registerMessageHandler(TEST_DB, "ZMQ_ACK_UT", &handler);
+
+    DBConnector db(TEST_DB, 0, true);
+    ZmqClient client(pushEndpoint);
+    client.enableAcks(4);
+    ZmqProducerStateTable p(&db, "ZMQ_ACK_UT", client, false);
+
+    vector<string> expected;
+    for (int i = 0; i < count; i++)
+    {
+        auto key = "key_" + to_string(i);
+        expected.push_back(key);
+        p.set(key, vector<FieldValueTuple>{{"field", "value"}});
+
+        // never more batches in flight than the window
+        EXPECT_LE(client.getInFlightCount(), 4U);
+    }
+
+    // every batch was handled once the acks are in
+    EXPECT_TRUE(p.waitForAcks(5000));
+    EXPECT_EQ(client.getInFlightCount(), 0U);
+    EXPECT_EQ(handler.getKeys(), expected);
+
+    // a batch without handler is reported
+    ZmqProducerStateTable unknown(&db, "ZMQ_ACK_UNKNOWN_UT", client, false);
+    unknown.set("key", vector<FieldValueTuple>{{"field", "value"}});
+    EXPECT_THROW(unknown.waitForAcks(5000), system_error);
+    EXPECT_TRUE(client.waitForAcks(5000));
+}
+
+TEST(ZmqServer, acks)
+{
+    testAcks("1242", 0);
+}
+
+TEST(ZmqServer, acks_decode_threads)
+{
+    testAcks("1243", 2);
+}